@@ -0,0 +1,339 @@
+//Standard includes
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+//Project includes
+#include "../src/Maths.h"
+#include "../src/DataTypes.h"
+#include "../src/Utils.h"
+#include "../src/BRDFs.h"
+
+using namespace dae;
+
+namespace
+{
+	constexpr unsigned int RAY_SEED{ 0x5EED };
+	constexpr int RAY_COUNT{ 4096 };
+
+	// Each kernel runs for at least this long per sample, the fastest of all samples is reported
+	constexpr double MIN_SAMPLE_SECONDS{ .2 };
+	constexpr int SAMPLE_COUNT{ 5 };
+
+	// Keeps the optimizer from discarding the kernels
+	volatile uint64_t g_Sink{};
+
+	template<typename Fn>
+	void Measure( const std::string& name, uint64_t opsPerIteration, Fn&& fn )
+	{
+		using clock = std::chrono::steady_clock;
+
+		// Warm up caches and find how many iterations fill one sample
+		uint64_t iterations{ 1 };
+		while ( true )
+		{
+			const auto start{ clock::now( ) };
+			for ( uint64_t i{}; i < iterations; ++i )
+			{
+				g_Sink = g_Sink + fn( );
+			}
+			const double seconds{ std::chrono::duration<double>( clock::now( ) - start ).count( ) };
+			if ( seconds >= MIN_SAMPLE_SECONDS )
+			{
+				break;
+			}
+			iterations *= 2;
+		}
+
+		double bestNsPerOp{ DBL_MAX };
+		for ( int sample{}; sample < SAMPLE_COUNT; ++sample )
+		{
+			const auto start{ clock::now( ) };
+			for ( uint64_t i{}; i < iterations; ++i )
+			{
+				g_Sink = g_Sink + fn( );
+			}
+			const double ns{ std::chrono::duration<double, std::nano>( clock::now( ) - start ).count( ) };
+			bestNsPerOp = std::min( bestNsPerOp, ns / double( iterations * opsPerIteration ) );
+		}
+
+		std::cout << std::left << std::setw( 60 ) << name
+			<< std::right << std::setw( 12 ) << std::fixed << std::setprecision( 2 ) << bestNsPerOp << " ns/op"
+			<< std::setw( 16 ) << std::setprecision( 0 ) << 1e9 / bestNsPerOp << " ops/s" << std::endl;
+	}
+
+	Vector3 RandomPointInBox( const Vector3& min, const Vector3& max, int& index )
+	{
+		const float x{ Get1dNoiseZeroToOne( index++, RAY_SEED ) };
+		const float y{ Get1dNoiseZeroToOne( index++, RAY_SEED ) };
+		const float z{ Get1dNoiseZeroToOne( index++, RAY_SEED ) };
+		return { Lerpf( min.x, max.x, x ), Lerpf( min.y, max.y, y ), Lerpf( min.z, max.z, z ) };
+	}
+
+	// Rays start on a sphere around the target and aim at random points inside a box twice its size,
+	// so a good share of them hits and the rest misses at varying distances
+	std::vector<Ray> GenerateRays( const Vector3& min, const Vector3& max )
+	{
+		const Vector3 center{ ( min + max ) * .5f };
+		const Vector3 halfExtent{ ( max - min ) * .5f };
+		const float radius{ std::max( halfExtent.Magnitude( ), 1.f ) * 4.f };
+
+		std::vector<Ray> rays{};
+		rays.reserve( RAY_COUNT );
+
+		int index{};
+		for ( int i{}; i < RAY_COUNT; ++i )
+		{
+			Vector3 direction{ RandomPointInBox( -Vector3{ 1.f, 1.f, 1.f }, Vector3{ 1.f, 1.f, 1.f }, index ) };
+			if ( direction.SqrMagnitude( ) < FLT_EPSILON )
+			{
+				direction = Vector3::UnitZ;
+			}
+			const Vector3 origin{ center + direction.Normalized( ) * radius };
+			const Vector3 target{ RandomPointInBox( center - halfExtent * 2.f, center + halfExtent * 2.f, index ) };
+
+			rays.push_back( { origin, ( target - origin ).Normalized( ) } );
+		}
+		return rays;
+	}
+
+	std::unique_ptr<TriangleMesh> LoadMesh( const std::string& path )
+	{
+		auto pMesh{ std::make_unique<TriangleMesh>( ) };
+		if ( !Utils::ParseOBJ( path, pMesh->positions, pMesh->normals, pMesh->indices ) || pMesh->indices.empty( ) )
+		{
+			std::cout << "Could not load " << path << std::endl;
+			return nullptr;
+		}
+		pMesh->UpdateTransforms( );
+		return pMesh;
+	}
+
+	// Heightfield of (size x size) quads, a well-behaved mesh for the BVH
+	std::unique_ptr<TriangleMesh> CreateGridMesh( int size )
+	{
+		auto pMesh{ std::make_unique<TriangleMesh>( ) };
+		int index{};
+		for ( int z{}; z <= size; ++z )
+		{
+			for ( int x{}; x <= size; ++x )
+			{
+				const float height{ Get1dNoiseZeroToOne( index++, RAY_SEED ) * .1f };
+				pMesh->positions.emplace_back( float( x ) / size - .5f, height, float( z ) / size - .5f );
+			}
+		}
+		for ( int z{}; z < size; ++z )
+		{
+			for ( int x{}; x < size; ++x )
+			{
+				const uint32_t i0{ uint32_t( z * ( size + 1 ) + x ) };
+				const uint32_t i1{ i0 + 1 };
+				const uint32_t i2{ i0 + size + 1 };
+				const uint32_t i3{ i2 + 1 };
+				pMesh->indices.insert( pMesh->indices.end( ), { i0, i2, i1, i1, i2, i3 } );
+			}
+		}
+		pMesh->cullMode = TriangleCullMode::NoCulling;
+		pMesh->CalculateNormals( );
+		pMesh->UpdateTransforms( );
+		return pMesh;
+	}
+
+	// Randomly placed and oriented triangles, the worst case for the BVH
+	std::unique_ptr<TriangleMesh> CreateTriangleSoup( int triangleCount )
+	{
+		auto pMesh{ std::make_unique<TriangleMesh>( ) };
+		int index{};
+		for ( int i{}; i < triangleCount; ++i )
+		{
+			const Vector3 center{ RandomPointInBox( { -1.f, -1.f, -1.f }, { 1.f, 1.f, 1.f }, index ) };
+			for ( int v{}; v < 3; ++v )
+			{
+				pMesh->indices.push_back( uint32_t( pMesh->positions.size( ) ) );
+				pMesh->positions.push_back( center + RandomPointInBox( { -.05f, -.05f, -.05f }, { .05f, .05f, .05f }, index ) );
+			}
+		}
+		pMesh->cullMode = TriangleCullMode::NoCulling;
+		pMesh->CalculateNormals( );
+		pMesh->UpdateTransforms( );
+		return pMesh;
+	}
+
+	void BenchmarkPrimitives( )
+	{
+		const Sphere sphere{ { 0.f, 0.f, 0.f }, 1.f };
+		const std::vector<Ray> sphereRays{ GenerateRays( { -1.f, -1.f, -1.f }, { 1.f, 1.f, 1.f } ) };
+		Measure( "HitTest_Sphere", RAY_COUNT, [&]( )
+			{
+				uint64_t hits{};
+				for ( const Ray& ray : sphereRays )
+				{
+					HitRecord hitRecord{};
+					hits += GeometryUtils::HitTest_Sphere( sphere, ray, hitRecord );
+				}
+				return hits;
+			} );
+		Measure( "HitTest_Sphere (shadow)", RAY_COUNT, [&]( )
+			{
+				uint64_t hits{};
+				for ( const Ray& ray : sphereRays )
+				{
+					hits += GeometryUtils::HitTest_Sphere( sphere, ray );
+				}
+				return hits;
+			} );
+
+		const Plane plane{ { 0.f, 0.f, 0.f }, { 0.f, 1.f, 0.f } };
+		const std::vector<Ray> planeRays{ GenerateRays( { -1.f, 0.f, -1.f }, { 1.f, 0.f, 1.f } ) };
+		Measure( "HitTest_Plane", RAY_COUNT, [&]( )
+			{
+				uint64_t hits{};
+				for ( const Ray& ray : planeRays )
+				{
+					HitRecord hitRecord{};
+					hits += GeometryUtils::HitTest_Plane( plane, ray, hitRecord );
+				}
+				return hits;
+			} );
+
+		Triangle triangle{ { -.75f, 1.5f, 0.f }, { .75f, 0.f, 0.f }, { -.75f, 0.f, 0.f } };
+		triangle.cullMode = TriangleCullMode::NoCulling;
+		const std::vector<Ray> triangleRays{ GenerateRays( { -.75f, 0.f, 0.f }, { .75f, 1.5f, 0.f } ) };
+		Measure( "HitTest_Triangle", RAY_COUNT, [&]( )
+			{
+				uint64_t hits{};
+				for ( const Ray& ray : triangleRays )
+				{
+					HitRecord hitRecord{};
+					hits += GeometryUtils::HitTest_Triangle( triangle, ray, hitRecord );
+				}
+				return hits;
+			} );
+	}
+
+	// The per sample math USE_FAST_MATH swaps out: normalizing, sampling directions and the Cook-Torrance terms
+	void BenchmarkShadingMath( )
+	{
+		const std::vector<Ray> rays{ GenerateRays( { -1.f, -1.f, -1.f }, { 1.f, 1.f, 1.f } ) };
+		Measure( "Vector3::Normalize", RAY_COUNT, [&]( )
+			{
+				float sum{};
+				for ( const Ray& ray : rays )
+				{
+					Vector3 v{ ray.origin };
+					sum += v.Normalize( ) + v.x;
+				}
+				return uint64_t( sum );
+			} );
+		Measure( "GetPointInRadius", RAY_COUNT, [&]( )
+			{
+				float sum{};
+				for ( const Ray& ray : rays )
+				{
+					sum += LightUtils::GetPointInRadius( ray.origin, .5f, ray.direction.x * .5f + .5f, ray.direction.y * .5f + .5f ).z;
+				}
+				return uint64_t( sum );
+			} );
+		Measure( "GetCosineWeightedDirection", RAY_COUNT, [&]( )
+			{
+				float sum{};
+				for ( const Ray& ray : rays )
+				{
+					sum += LightUtils::GetCosineWeightedDirection( ray.direction, ray.direction.x * .5f + .5f, ray.direction.y * .5f + .5f ).z;
+				}
+				return uint64_t( sum );
+			} );
+		Measure( "Fresnel + GGX + Smith", RAY_COUNT, [&]( )
+			{
+				float sum{};
+				const Vector3 n{ Vector3::UnitY };
+				for ( const Ray& ray : rays )
+				{
+					const Vector3 v{ -ray.direction };
+					const Vector3 l{ Vector3::Reflect( ray.direction, n ) };
+					const Vector3 h{ ( v + l ).Normalized( ) };
+					sum += BRDF::FresnelFunction_Schlick( h, v, { .04f, .04f, .04f } ).r
+						+ BRDF::NormalDistribution_GGX( n, h, .3f )
+						+ BRDF::GeometryFunction_Smith( n, v, l, .3f );
+				}
+				return uint64_t( sum );
+			} );
+	}
+
+	void BenchmarkMesh( const std::string& name, const TriangleMesh& mesh )
+	{
+		const uint64_t triangleCount{ mesh.indices.size( ) / 3 };
+		const std::string label{ name + " (" + std::to_string( triangleCount ) + " tris)" };
+
+		const BVHNode& root{ mesh.pBVHRoot[0] };
+		const std::vector<Ray> rays{ GenerateRays( root.aabbMin, root.aabbMax ) };
+
+		Measure( "SlabTest_TriangleMesh " + label, RAY_COUNT, [&]( )
+			{
+				uint64_t hits{};
+				for ( const Ray& ray : rays )
+				{
+					hits += GeometryUtils::SlabTest_TriangleMesh( root.aabbMin, root.aabbMax, ray );
+				}
+				return hits;
+			} );
+		Measure( "HitTest_TriangleMesh " + label, RAY_COUNT, [&]( )
+			{
+				uint64_t hits{};
+				for ( const Ray& ray : rays )
+				{
+					HitRecord hitRecord{};
+					hits += GeometryUtils::HitTest_TriangleMesh( mesh, ray, hitRecord );
+				}
+				return hits;
+			} );
+		Measure( "HitTest_TriangleMesh (shadow) " + label, RAY_COUNT, [&]( )
+			{
+				uint64_t hits{};
+				for ( const Ray& ray : rays )
+				{
+					hits += GeometryUtils::HitTest_TriangleMesh( mesh, ray );
+				}
+				return hits;
+			} );
+
+		std::vector<BVHNode> nodes( triangleCount * 2 - 1 );
+		Measure( "BuildBVH " + label, 1, [&]( )
+			{
+				MeshBVHNodeBuilder builder{ mesh.transformedPositions, mesh.indices };
+				builder.BuildBVH( nodes.data( ) );
+				return uint64_t( nodes[0].triCount );
+			} );
+	}
+}
+
+int main( int argc, char* argv[] )
+{
+	// Optional argument: directory holding the .obj resources
+	const std::string resourceDir{ argc > 1 ? argv[1] : "resources" };
+
+	std::cout << "+----------------------------------------------------+" << std::endl;
+	std::cout << "| Micro benchmarks (" << RAY_COUNT << " rays, seed " << RAY_SEED << ")" << std::endl;
+	std::cout << "+----------------------------------------------------+" << std::endl;
+
+	BenchmarkPrimitives( );
+	BenchmarkShadingMath( );
+
+	for ( const char* fileName : { "simple_quad.obj", "simple_cube.obj", "simple_object.obj", "lowpoly_bunny.obj" } )
+	{
+		if ( const auto pMesh{ LoadMesh( resourceDir + "/" + fileName ) } )
+		{
+			BenchmarkMesh( fileName, *pMesh );
+		}
+	}
+
+	BenchmarkMesh( "grid 32x32", *CreateGridMesh( 32 ) );
+	BenchmarkMesh( "grid 128x128", *CreateGridMesh( 128 ) );
+	BenchmarkMesh( "soup", *CreateTriangleSoup( 4096 ) );
+
+	return 0;
+}
@@ -45,7 +45,7 @@ namespace dae
 		 */
 		static ColorRGB FresnelFunction_Schlick(const Vector3& h, const Vector3& v, const ColorRGB& f0)
 		{
-			return f0 + (ColorRGB{ 1.f, 1.f, 1.f } - f0) * powf( 1 - Vector3::Dot( h, v ), 5 );
+			return f0 + (ColorRGB{ 1.f, 1.f, 1.f } - f0) * Pow<5>( 1 - Vector3::Dot( h, v ) );
 		}
 
 		/**
@@ -57,8 +57,8 @@ namespace dae
 		 */
 		static float NormalDistribution_GGX(const Vector3& n, const Vector3& h, float roughness)
 		{
-			const float a{ powf( roughness, 4 ) };
-			return a / ( PI * powf( powf( Vector3::Dot( n, h ), 2 ) * ( a - 1 ) + 1, 2 ) );
+			const float a{ Pow<4>( roughness ) };
+			return a / ( PI * Square( Square( Vector3::Dot( n, h ) ) * ( a - 1 ) + 1 ) );
 		}
 
 
@@ -72,7 +72,7 @@ namespace dae
 		static float GeometryFunction_SchlickGGX(const Vector3& n, const Vector3& v, float roughness)
 		{
 			const float orthogonality{ Vector3::Dot( n, v ) };
-			const float k{ powf( roughness + 1, 2 ) / 8 };
+			const float k{ Square( roughness + 1 ) / 8 };
 			return orthogonality / (orthogonality * ( 1 - k ) + k );
 		}
 
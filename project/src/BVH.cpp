@@ -40,6 +40,8 @@ MeshBVHNodeBuilder::MeshBVHNodeBuilder( const std::vector<Vector3>& positions, c
 
 void MeshBVHNodeBuilder::BuildBVH( BVHNode bvhNode[] )
 {
+	PROFILE_SCOPE( "MeshBVHNodeBuilder::BuildBVH" );
+
 	m_NodesUsed = 1;
 
 	// Initialize triangles
@@ -0,0 +1,310 @@
+#include "Benchmark.h"
+
+//External includes
+#include "SDL.h"
+
+//Standard includes
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <utility>
+
+//Project includes
+#include "Renderer.h"
+#include "Scene.h"
+#include "Timer.h"
+
+using namespace dae;
+
+namespace
+{
+	constexpr int LIGHTING_MODE_COUNT{ 4 };
+	constexpr int SHADOW_MODE_COUNT{ 3 };
+
+	// Scripted camera path: a slow dolly towards the scene while sweeping left/right and nodding
+	constexpr float CAMERA_PATH_DOLLY{ 1.5f };
+	constexpr float CAMERA_PATH_YAW{ .25f };
+	constexpr float CAMERA_PATH_PITCH{ .1f };
+
+	double Percentile( std::vector<double> values, double percentile )
+	{
+		if ( values.empty( ) )
+		{
+			return 0.0;
+		}
+
+		std::sort( values.begin( ), values.end( ) );
+		const size_t idx{ std::min( values.size( ) - 1, size_t( percentile * double( values.size( ) - 1 ) + .5 ) ) };
+		return values[idx];
+	}
+
+	// Scene names are free text, quotes and backslashes would end the JSON string early
+	void WriteEscaped( std::ofstream& fileStream, const std::string& text )
+	{
+		for ( const char character : text )
+		{
+			if ( character == '"' || character == '\\' )
+			{
+				fileStream << '\\';
+			}
+			fileStream << character;
+		}
+	}
+
+	// Raw counters, IPC and misses per ray of one phase. Missing counters are written as null.
+	void WriteCounters( std::ofstream& fileStream, const PerfCounterValues& counters, uint64_t rays )
+	{
+		const auto writeValue = [&fileStream]( const std::optional<double>& value )
+			{
+				if ( value )
+					fileStream << *value;
+				else
+					fileStream << "null";
+			};
+		const auto perRay = [rays]( const std::optional<uint64_t>& value ) -> std::optional<double>
+			{
+				if ( !value || rays == 0 )
+					return std::nullopt;
+				return double( *value ) / double( rays );
+			};
+
+		fileStream << "{ ";
+		for ( int counterIdx{}; counterIdx < int( PerfCounter::Count ); ++counterIdx )
+		{
+			const auto& value{ counters[PerfCounter( counterIdx )] };
+			fileStream << "\"" << PerfCounters::GetName( PerfCounter( counterIdx ) ) << "\": ";
+			writeValue( value ? std::optional<double>{ double( *value ) } : std::nullopt );
+			fileStream << ", ";
+		}
+
+		const auto& cycles{ counters[PerfCounter::Cycles] };
+		const auto& instructions{ counters[PerfCounter::Instructions] };
+		fileStream << "\"ipc\": ";
+		writeValue( cycles && instructions && *cycles > 0 ? std::optional<double>{ double( *instructions ) / double( *cycles ) } : std::nullopt );
+		fileStream << ", \"l1dMissesPerRay\": ";
+		writeValue( perRay( counters[PerfCounter::L1DataMisses] ) );
+		fileStream << ", \"llcMissesPerRay\": ";
+		writeValue( perRay( counters[PerfCounter::LastLevelCacheMisses] ) );
+		fileStream << ", \"branchMissesPerRay\": ";
+		writeValue( perRay( counters[PerfCounter::BranchMisses] ) );
+		fileStream << " }";
+	}
+}
+
+Benchmark::Benchmark( Renderer* pRenderer, std::vector<std::function<Scene*( )>> sceneFactories, const BenchmarkSettings& settings ) :
+	m_pRenderer{ pRenderer },
+	m_SceneFactories{ std::move( sceneFactories ) },
+	m_Settings{ settings }
+{
+}
+
+bool Benchmark::Run( )
+{
+	m_Results.clear( );
+
+	std::cout << "**BENCHMARK STARTED**\n";
+	if ( !m_PerfCounters.IsAvailable( ) )
+	{
+		std::cout << ">> Hardware counters unavailable (" << m_PerfCounters.GetError( ) << "), reporting timings only\n";
+	}
+	for ( const auto& fnFactory : m_SceneFactories )
+	{
+		Scene* pScene{ fnFactory( ) };
+		pScene->Initialize( );
+
+		for ( int lightingMode{}; lightingMode < LIGHTING_MODE_COUNT; ++lightingMode )
+		{
+			for ( int shadowMode{}; shadowMode < SHADOW_MODE_COUNT; ++shadowMode )
+			{
+				for ( const bool globalIllumination : { false, true } )
+				{
+					m_Results.push_back( RunScene( pScene, lightingMode, shadowMode, globalIllumination ) );
+				}
+			}
+		}
+
+		std::cout << ">> " << pScene->GetSceneName( ) << " done" << std::endl;
+		delete pScene;
+	}
+	std::cout << "**BENCHMARK FINISHED**\n";
+
+	return WriteReport( );
+}
+
+Benchmark::RunResult Benchmark::RunScene( Scene* pScene, int lightingMode, int shadowMode, bool globalIllumination )
+{
+	m_pRenderer->SetLightingMode( LightingMode( lightingMode ) );
+	m_pRenderer->SetShadowMode( ShadowMode( shadowMode ) );
+	m_pRenderer->SetGlobalIllumination( globalIllumination );
+	// Runs start cold, and a new scene can reuse the address of the deleted one
+	m_pRenderer->ResetSceneCaches( );
+
+	RunResult result{};
+	result.sceneName = pScene->GetSceneName( );
+	result.lightingMode = lightingMode;
+	result.shadowMode = shadowMode;
+	result.globalIllumination = globalIllumination;
+	result.frames.reserve( m_Settings.framesPerRun );
+
+	// Every run replays the same animation time line and camera path
+	Timer timer{};
+	timer.SetFixedTimeStep( m_Settings.timeStep );
+	timer.Reset( );
+
+	Camera& camera{ pScene->GetCamera( ) };
+	const Vector3 startOrigin{ camera.origin };
+
+	const double msPerCount{ 1000.0 / double( SDL_GetPerformanceFrequency( ) ) };
+	for ( uint32_t frame{}; frame < m_Settings.framesPerRun; ++frame )
+	{
+		FrameResult frameResult{};
+		Renderer::ResetRayCounters( );
+
+		m_PerfCounters.Start( );
+		const uint64_t updateStart{ SDL_GetPerformanceCounter( ) };
+		timer.Update( );
+		pScene->Update( &timer );
+		ApplyCameraPath( camera, startOrigin, frame );
+		const uint64_t updateEnd{ SDL_GetPerformanceCounter( ) };
+		frameResult.updateCounters = m_PerfCounters.Stop( );
+
+		m_PerfCounters.Start( );
+		const uint64_t renderStart{ SDL_GetPerformanceCounter( ) };
+		m_pRenderer->Render( pScene );
+		const uint64_t renderEnd{ SDL_GetPerformanceCounter( ) };
+		frameResult.renderCounters = m_PerfCounters.Stop( );
+
+		const RayCounters counters{ Renderer::GetRayCounters( ) };
+		frameResult.updateMs = double( updateEnd - updateStart ) * msPerCount;
+		frameResult.renderMs = double( renderEnd - renderStart ) * msPerCount;
+		frameResult.primaryRays = counters.primary;
+		frameResult.shadowRays = counters.shadow;
+		frameResult.secondaryRays = counters.secondary;
+		result.frames.push_back( frameResult );
+	}
+
+	// Leave the scene as we found it for the next run
+	camera.origin = startOrigin;
+	camera.totalYaw = 0.f;
+	camera.totalPitch = 0.f;
+	camera.ApplyCameraRotations( );
+
+	return result;
+}
+
+void Benchmark::ApplyCameraPath( Camera& camera, const Vector3& startOrigin, uint32_t frame ) const
+{
+	const float progress{ m_Settings.framesPerRun > 1 ? float( frame ) / float( m_Settings.framesPerRun - 1 ) : 0.f };
+
+	camera.totalYaw = sinf( progress * PI_2 ) * CAMERA_PATH_YAW;
+	camera.totalPitch = sinf( progress * PI ) * CAMERA_PATH_PITCH;
+	camera.ApplyCameraRotations( );
+
+	camera.origin = startOrigin + Vector3::UnitZ * ( progress * CAMERA_PATH_DOLLY );
+}
+
+bool Benchmark::WriteReport( ) const
+{
+	std::ofstream fileStream( m_Settings.outputPath );
+	if ( !fileStream )
+	{
+		std::cout << "Could not write " << m_Settings.outputPath << std::endl;
+		return false;
+	}
+
+	uint64_t totalRays{};
+	double totalRenderMs{};
+
+	fileStream << "{\n";
+	fileStream << "\t\"width\": " << m_pRenderer->GetWidth( ) << ",\n";
+	fileStream << "\t\"height\": " << m_pRenderer->GetHeight( ) << ",\n";
+	fileStream << "\t\"framesPerRun\": " << m_Settings.framesPerRun << ",\n";
+	fileStream << "\t\"timeStep\": " << m_Settings.timeStep << ",\n";
+	fileStream << "\t\"hardwareCounters\": " << ( m_PerfCounters.IsAvailable( ) ? "true" : "false" ) << ",\n";
+	fileStream << "\t\"runs\": [\n";
+	for ( size_t runIdx{}; runIdx < m_Results.size( ); ++runIdx )
+	{
+		const RunResult& run{ m_Results[runIdx] };
+
+		std::vector<double> frameTimes{};
+		RayCounters runRays{};
+		double runRenderMs{};
+		PerfCounterValues runUpdateCounters{};
+		PerfCounterValues runRenderCounters{};
+		for ( const FrameResult& frame : run.frames )
+		{
+			runUpdateCounters += frame.updateCounters;
+			runRenderCounters += frame.renderCounters;
+			frameTimes.push_back( frame.updateMs + frame.renderMs );
+			runRays.primary += frame.primaryRays;
+			runRays.shadow += frame.shadowRays;
+			runRays.secondary += frame.secondaryRays;
+			runRenderMs += frame.renderMs;
+		}
+		totalRays += runRays.Total( );
+		totalRenderMs += runRenderMs;
+
+		double sumMs{};
+		for ( const double ms : frameTimes )
+		{
+			sumMs += ms;
+		}
+		const double meanMs{ frameTimes.empty( ) ? 0.0 : sumMs / double( frameTimes.size( ) ) };
+		const double mraysPerSecond{ runRenderMs > 0.0 ? double( runRays.Total( ) ) / ( runRenderMs * 1000.0 ) : 0.0 };
+
+		fileStream << "\t\t{\n";
+		fileStream << "\t\t\t\"scene\": \"";
+		WriteEscaped( fileStream, run.sceneName );
+		fileStream << "\",\n";
+		fileStream << "\t\t\t\"lightingMode\": \"" << lightingModeMap[run.lightingMode] << "\",\n";
+		fileStream << "\t\t\t\"shadowMode\": \"" << shadowModeMap[run.shadowMode] << "\",\n";
+		fileStream << "\t\t\t\"globalIllumination\": " << ( run.globalIllumination ? "true" : "false" ) << ",\n";
+		fileStream << "\t\t\t\"frameTimeMs\": { ";
+		fileStream << "\"min\": " << Percentile( frameTimes, 0.0 ) << ", ";
+		fileStream << "\"mean\": " << meanMs << ", ";
+		fileStream << "\"p50\": " << Percentile( frameTimes, .5 ) << ", ";
+		fileStream << "\"p90\": " << Percentile( frameTimes, .9 ) << ", ";
+		fileStream << "\"p99\": " << Percentile( frameTimes, .99 ) << ", ";
+		fileStream << "\"max\": " << Percentile( frameTimes, 1.0 ) << " },\n";
+		fileStream << "\t\t\t\"rays\": { ";
+		fileStream << "\"primary\": " << runRays.primary << ", ";
+		fileStream << "\"shadow\": " << runRays.shadow << ", ";
+		fileStream << "\"secondary\": " << runRays.secondary << ", ";
+		fileStream << "\"total\": " << runRays.Total( ) << " },\n";
+		fileStream << "\t\t\t\"mraysPerSecond\": " << mraysPerSecond << ",\n";
+		if ( m_PerfCounters.IsAvailable( ) )
+		{
+			fileStream << "\t\t\t\"counters\": {\n\t\t\t\t\"update\": ";
+			WriteCounters( fileStream, runUpdateCounters, runRays.Total( ) );
+			fileStream << ",\n\t\t\t\t\"render\": ";
+			WriteCounters( fileStream, runRenderCounters, runRays.Total( ) );
+			fileStream << "\n\t\t\t},\n";
+		}
+		else
+		{
+			fileStream << "\t\t\t\"counters\": null,\n";
+		}
+		fileStream << "\t\t\t\"frames\": [\n";
+		for ( size_t frameIdx{}; frameIdx < run.frames.size( ); ++frameIdx )
+		{
+			const FrameResult& frame{ run.frames[frameIdx] };
+			fileStream << "\t\t\t\t{ ";
+			fileStream << "\"updateMs\": " << frame.updateMs << ", ";
+			fileStream << "\"renderMs\": " << frame.renderMs << ", ";
+			fileStream << "\"primaryRays\": " << frame.primaryRays << ", ";
+			fileStream << "\"shadowRays\": " << frame.shadowRays << ", ";
+			fileStream << "\"secondaryRays\": " << frame.secondaryRays << " }";
+			fileStream << ( frameIdx + 1 < run.frames.size( ) ? ",\n" : "\n" );
+		}
+		fileStream << "\t\t\t]\n";
+		fileStream << "\t\t}" << ( runIdx + 1 < m_Results.size( ) ? ",\n" : "\n" );
+	}
+	fileStream << "\t],\n";
+	fileStream << "\t\"totalRays\": " << totalRays << ",\n";
+	fileStream << "\t\"totalRenderMs\": " << totalRenderMs << ",\n";
+	fileStream << "\t\"mraysPerSecond\": " << ( totalRenderMs > 0.0 ? double( totalRays ) / ( totalRenderMs * 1000.0 ) : 0.0 ) << "\n";
+	fileStream << "}\n";
+
+	std::cout << ">> Report written to " << m_Settings.outputPath << std::endl;
+	return true;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+//Standard includes
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+//Project includes
+#include "PerfCounters.h"
+
+namespace dae
+{
+	class Scene;
+	class Renderer;
+	struct Camera;
+	struct Vector3;
+
+	struct BenchmarkSettings
+	{
+		uint32_t framesPerRun{ 16 };
+		float timeStep{ 1.f / 30.f };
+		std::string outputPath{ "benchmark.json" };
+	};
+
+	/**
+	 * \brief Deterministic end-to-end benchmark. Renders every scene along a scripted camera path,
+	 * once for each combination of lighting mode, shadow mode and global illumination, and writes
+	 * frame times, ray counts, throughput and (when available) hardware counters to a JSON report.
+	 */
+	class Benchmark final
+	{
+	public:
+		Benchmark( Renderer* pRenderer, std::vector<std::function<Scene*( )>> sceneFactories, const BenchmarkSettings& settings );
+		~Benchmark( ) = default;
+
+		Benchmark( const Benchmark& ) = delete;
+		Benchmark( Benchmark&& ) noexcept = delete;
+		Benchmark& operator=( const Benchmark& ) = delete;
+		Benchmark& operator=( Benchmark&& ) noexcept = delete;
+
+		// Returns false if the report could not be written
+		bool Run( );
+
+	private:
+		struct FrameResult
+		{
+			double updateMs{};
+			double renderMs{};
+			uint64_t primaryRays{};
+			uint64_t shadowRays{};
+			uint64_t secondaryRays{};
+
+			PerfCounterValues updateCounters{};
+			PerfCounterValues renderCounters{};
+		};
+
+		struct RunResult
+		{
+			std::string sceneName{};
+			int lightingMode{};
+			int shadowMode{};
+			bool globalIllumination{};
+			std::vector<FrameResult> frames{};
+		};
+
+		Renderer* m_pRenderer;
+		std::vector<std::function<Scene*( )>> m_SceneFactories;
+		BenchmarkSettings m_Settings;
+
+		// Opened before the first frame so the render workers inherit the counters
+		PerfCounters m_PerfCounters{};
+
+		std::vector<RunResult> m_Results{};
+
+		RunResult RunScene( Scene* pScene, int lightingMode, int shadowMode, bool globalIllumination );
+		void ApplyCameraPath( Camera& camera, const Vector3& startOrigin, uint32_t frame ) const;
+
+		bool WriteReport( ) const;
+	};
+}
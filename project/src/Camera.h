@@ -3,10 +3,24 @@
 #include <SDL_mouse.h>
 
 #include "Maths.h"
-#include "Timer.h"
 
 namespace dae
 {
+	// Keyboard and mouse input gathered since the camera last moved
+	struct CameraInput
+	{
+		// Seconds each direction was held: right, up and forward, in camera space
+		Vector3 movement{};
+		// Mouse travel in pixels with the left button down, however long it took
+		float yaw{};
+		float pitch{};
+
+		bool IsEmpty( ) const
+		{
+			return movement.SqrMagnitude( ) == 0.f && yaw == 0.f && pitch == 0.f;
+		}
+	};
+
 	struct Camera
 	{
 		Camera() = default;
@@ -19,6 +33,7 @@ namespace dae
 		}
 
 		const float MOVEMENT_SPEED{ 3.f };
+		// Radians per pixel of mouse travel
 		const float CAMERA_ROTATION_SPEED{ 0.01f };
 		const int8_t INVERT_CAMERA_AXIS{ 1 };
 
@@ -46,13 +61,12 @@ namespace dae
 			return cameraToWorld;
 		}
 
-		void Update(Timer* pTimer)
+		// Reads the keyboard and mouse, must run on the thread that handles the window events
+		static void SampleInput( float deltaTime, CameraInput& input )
 		{
-			const float deltaTime = pTimer->GetElapsed();
-
 			//Keyboard Input
 			const uint8_t* pKeyboardState = SDL_GetKeyboardState(nullptr);
-			ProcessKeyboardInput( pKeyboardState, deltaTime );
+			ProcessKeyboardInput( pKeyboardState, deltaTime, input );
 
 			//Mouse Input
 			int mouseX{}, mouseY{};
@@ -60,9 +74,19 @@ namespace dae
 			const bool leftButtonPressed = mouseState & SDL_BUTTON( SDL_BUTTON_LMASK );
 			if ( leftButtonPressed && (mouseX || mouseY) )
 			{
-				// Only process mouse input if the mouse position has changed.
-				// Since the rotation matrix calculation is expensive, we only want to do it when necessary.
-				ProcessMouseInput( mouseX, mouseY, deltaTime );
+				input.yaw += float( mouseX );
+				input.pitch += float( mouseY );
+			}
+		}
+
+		void ApplyInput( const CameraInput& input )
+		{
+			origin += ( right * input.movement.x + up * input.movement.y + forward * input.movement.z ) * MOVEMENT_SPEED;
+
+			// Since the rotation matrix calculation is expensive, only rotate when the mouse moved
+			if ( input.yaw != 0.f || input.pitch != 0.f )
+			{
+				ProcessMouseInput( input.yaw, input.pitch );
 			}
 		}
 
@@ -86,42 +110,40 @@ namespace dae
 		}
 
 	private:
-		inline void ProcessKeyboardInput( const uint8_t* pKeyboardState, float deltaTime )
+		static inline void ProcessKeyboardInput( const uint8_t* pKeyboardState, float deltaTime, CameraInput& input )
 		{
-			const float speed{ deltaTime * MOVEMENT_SPEED };
-
 			if ( pKeyboardState[SDL_SCANCODE_W] )
 			{
-				origin += forward * speed;
+				input.movement.z += deltaTime;
 			}
 			if ( pKeyboardState[SDL_SCANCODE_A] )
 			{
-				origin += -right * speed;
+				input.movement.x -= deltaTime;
 			}
 			if ( pKeyboardState[SDL_SCANCODE_S] )
 			{
-				origin += -forward * speed;
+				input.movement.z -= deltaTime;
 			}
 			if ( pKeyboardState[SDL_SCANCODE_D] )
 			{
-				origin += right * speed;
+				input.movement.x += deltaTime;
 			}
 			if ( pKeyboardState[SDL_SCANCODE_E] )
 			{
-				origin += up * speed;
+				input.movement.y += deltaTime;
 			}
 			if ( pKeyboardState[SDL_SCANCODE_Q] )
 			{
-				origin += -up * speed;
+				input.movement.y -= deltaTime;
 			}
 		}
 
-		inline void ProcessMouseInput( int mouseX, int mouseY, float deltaTime )
+		inline void ProcessMouseInput( float yaw, float pitch )
 		{
-			const float speed{ deltaTime * CAMERA_ROTATION_SPEED * INVERT_CAMERA_AXIS };
+			const float speed{ CAMERA_ROTATION_SPEED * INVERT_CAMERA_AXIS };
 
-			totalYaw += mouseX * speed;
-			totalPitch += mouseY * speed;
+			totalYaw += yaw * speed;
+			totalPitch += pitch * speed;
 
 			// Clamp pitch to prevent flipping
 			totalPitch = std::clamp( totalPitch, -PI_2 + FLT_EPSILON, PI_2 - FLT_EPSILON );
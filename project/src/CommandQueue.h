@@ -0,0 +1,49 @@
+#pragma once
+
+//Standard includes
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace dae
+{
+	// Work posted from the main thread and executed by the render thread between two frames,
+	// so the renderer and the scene are never changed while a frame is being traced.
+	class CommandQueue final
+	{
+	public:
+		CommandQueue( ) = default;
+		~CommandQueue( ) = default;
+
+		CommandQueue( const CommandQueue& ) = delete;
+		CommandQueue( CommandQueue&& ) noexcept = delete;
+		CommandQueue& operator=( const CommandQueue& ) = delete;
+		CommandQueue& operator=( CommandQueue&& ) noexcept = delete;
+
+		void Push( std::function<void( )> command )
+		{
+			std::lock_guard lock{ m_Mutex };
+			m_Commands.push_back( std::move( command ) );
+		}
+
+		// Runs every pending command in the order it was pushed
+		void Execute( )
+		{
+			std::vector<std::function<void( )>> commands{};
+			{
+				std::lock_guard lock{ m_Mutex };
+				commands.swap( m_Commands );
+			}
+
+			for ( const auto& command : commands )
+			{
+				command( );
+			}
+		}
+
+	private:
+		std::mutex m_Mutex{};
+		std::vector<std::function<void( )>> m_Commands{};
+	};
+}
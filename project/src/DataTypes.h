@@ -3,6 +3,7 @@
 #include <vector>
 
 #include "Maths.h"
+#include "Profiler.h"
 
 namespace dae
 {
@@ -155,6 +156,10 @@ namespace dae
 		std::vector<Vector3> transformedPositions{};
 		std::vector<Vector3> transformedNormals{};
 
+		// Bumped every time the transformed geometry changes
+		uint32_t revision{};
+		Matrix appliedTransform{};
+
 		void Translate(const Vector3& translation)
 		{
 			translationTransform = Matrix::CreateTranslation(translation);
@@ -233,12 +238,24 @@ namespace dae
 
 		void UpdateTransforms()
 		{
+			PROFILE_SCOPE( "TriangleMesh::UpdateTransforms" );
+
 			//Calculate Final Transform 
 			//const auto trsMatrix{ translationTransform * rotationTransform * scaleTransform };
 			
 			//We actually use an RTS matrix instead because we're looking to do orbital rotations
 			const auto rtsMatrix{ rotationTransform * translationTransform * scaleTransform };
 
+			//Nothing to do when neither the transform nor the vertex count changed since the last update
+			if ( rtsMatrix == appliedTransform
+				&& transformedPositions.size( ) == positions.size( )
+				&& transformedNormals.size( ) == normals.size( ) )
+			{
+				return;
+			}
+			appliedTransform = rtsMatrix;
+			++revision;
+
 			//Clear Transformed Positions/Normals and reserve space
 			transformedPositions.clear( );
 			transformedPositions.reserve( positions.size( ) );
@@ -274,6 +291,8 @@ namespace dae
 		Vector3 direction{};
 		ColorRGB color{};
 		float intensity{};
+		// Distance beyond which the light is too faint to show, directional lights reach everywhere
+		float range{ FLT_MAX };
 
 		LightType type{};
 	};
@@ -313,6 +332,8 @@ namespace dae
 
 		float observedAreaMeasure;
 		float shadowFactor = 1.f;
+		// 1 / (sample count * probability) when the light was picked out of many, 1 when every light is shaded
+		float lightWeight = 1.f;
 	};
 
 	struct ShadeInfo
@@ -322,5 +343,17 @@ namespace dae
 		Ray reflectionRay;
 		float reflectance{ 0.f };
 	};
+
+	// How the primary hit of a pixel was lit, so the denoiser can filter the noisy parts on their own
+	struct LightingSplit
+	{
+		// Whether the lighting below adds up to the pixel color, mirrors and the background are left out
+		bool isFiltered{ false };
+		ColorRGB albedo{};
+		// Direct light as if nothing cast a shadow, and as traced with the shadows
+		ColorRGB unshadowedDirect{};
+		ColorRGB direct{};
+		ColorRGB indirect{};
+	};
 #pragma endregion
 }
\ No newline at end of file
@@ -0,0 +1,383 @@
+#include "Denoiser.h"
+
+//Standard includes
+#include <algorithm>
+#include <cmath>
+#include <execution>
+#include <numeric>
+
+//Project includes
+#include "SIMD.h"
+
+#define DENOISE_PASSES 3
+#define DENOISE_BAND_HEIGHT 16
+
+// Luminance edge stops of the shadow ratio and of the indirect light, relative to their local deviation
+#define DENOISE_SIGMA_SHADOW .5f
+#define DENOISE_SIGMA_INDIRECT 4.f
+// Distance of a tap off the pixel's tangent plane, relative to the pixel's depth
+#define DENOISE_SIGMA_PLANE .01f
+// Falloff of the weight as the normals turn apart, e^(-128 (1 - cos)) stops at facets and creases like cos^128
+#define DENOISE_NORMAL_SHARPNESS 128.f
+// Parts whose luminance varies less than this around a pixel are not filtered there
+#define DENOISE_MIN_DEVIATION .002f
+// Shadow ratios closer than this to a neighbour's are part of a shadow edge, not noise
+#define DENOISE_SHADOW_TOLERANCE .1f
+
+using namespace dae;
+
+namespace
+{
+	constexpr int LANE_COUNT{ 8 };
+	// The taps of the last pass reach two of its steps aside, and a row of lanes reads on past its last pixel
+	constexpr int PLANE_PADDING{ 2 * ( 1 << ( DENOISE_PASSES - 1 ) ) + LANE_COUNT };
+
+	// r g b and luminance of the shadow ratio, then of the indirect light
+	constexpr int TEXEL_PLANES{ 8 };
+
+	// x y z of the normal and position, the plane stop scale, then the luminance mean and stop scale of both parts
+	constexpr int NORMAL_PLANE{ 0 };
+	constexpr int POSITION_PLANE{ 3 };
+	constexpr int PLANE_SCALE_PLANE{ 6 };
+	constexpr int LUMINANCE_MEAN_PLANE{ 7 };
+	constexpr int LUMINANCE_SCALE_PLANE{ 9 };
+	constexpr int GUIDE_PLANES{ 11 };
+
+	// B3 spline, the 5x5 kernel is the outer product of these
+	constexpr float KERNEL[5]{ 1.f / 16.f, 1.f / 4.f, 3.f / 8.f, 1.f / 4.f, 1.f / 16.f };
+
+	alignas( 32 ) constexpr float LANE_OFFSETS[LANE_COUNT]{ 0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f };
+
+	inline float GetLuminance( float r, float g, float b )
+	{
+		return .2126f * r + .7152f * g + .0722f * b;
+	}
+
+	// Fraction of the unshadowed light that got through, fully lit where there is no light to tell
+	inline float GetShadowRatio( float direct, float unshadowed )
+	{
+		return unshadowed > 1e-4f ? direct / unshadowed : 1.f;
+	}
+
+	// Channels without albedo are not divided, nothing would be multiplied back
+	inline ColorRGB GetDemodulationAlbedo( const ColorRGB& albedo )
+	{
+		return { albedo.r > 1e-3f ? albedo.r : 1.f, albedo.g > 1e-3f ? albedo.g : 1.f, albedo.b > 1e-3f ? albedo.b : 1.f };
+	}
+
+	inline Float8 Abs( const Float8& values )
+	{
+		return Float8::Max( values, Float8{ 0.f } - values );
+	}
+
+	// e^-x as (1 - x / 256)^256, a handful of multiplications instead of an exponential. Up to 10 it falls at most
+	// a fifth faster, which only sharpens the edge stops a little. From 64 on it is zero, further out the squares
+	// would underflow into denormals, which are slow
+	inline Float8 GetEdgeWeight( const Float8& exponent )
+	{
+		Float8 weight{ ( Float8{ 1.f } - exponent * Float8{ 1.f / 256.f } ) & ( exponent < Float8{ 64.f } ) };
+		for ( int i{}; i < 8; ++i )
+		{
+			weight *= weight;
+		}
+		return weight;
+	}
+
+	// The lanes past the end of a row belong to the next one, another band may be writing it
+	inline void StoreLanes( const Float8& values, float* pValues, int laneCount )
+	{
+		if ( laneCount == LANE_COUNT )
+		{
+			values.Store( pValues );
+			return;
+		}
+
+		alignas( 32 ) float lanes[LANE_COUNT];
+		values.Store( lanes );
+		std::copy_n( lanes, laneCount, pValues );
+	}
+}
+
+Denoiser::Denoiser( uint32_t maxPixelCount ) :
+	m_PlaneSize{ int( maxPixelCount ) + 2 * PLANE_PADDING },
+	m_pGuides{ new float[GUIDE_PLANES * m_PlaneSize]{} },
+	m_pTexels{ new float[TEXEL_PLANES * m_PlaneSize]{}, new float[TEXEL_PLANES * m_PlaneSize]{} },
+	m_pOutput{ new ColorRGB[maxPixelCount]{} }
+{
+}
+
+Denoiser::~Denoiser( )
+{
+	delete[] m_pGuides;
+	delete[] m_pTexels[0];
+	delete[] m_pTexels[1];
+	delete[] m_pOutput;
+}
+
+const ColorRGB* Denoiser::Denoise( const ColorRGB* pColors, const LightingSplit* pSplits, const HitRecord* pPrimaryHits, int width, int height )
+{
+	const int bandCount{ ( height + DENOISE_BAND_HEIGHT - 1 ) / DENOISE_BAND_HEIGHT };
+	if ( int( m_Bands.size( ) ) != bandCount )
+	{
+		m_Bands.resize( bandCount );
+		std::iota( m_Bands.begin( ), m_Bands.end( ), 0 );
+	}
+
+	Prepare( pSplits, pPrimaryHits, width, height );
+
+	// Every pass doubles the distance between the taps
+	int sourceIdx{};
+	for ( int pass{}; pass < DENOISE_PASSES; ++pass )
+	{
+		const float* pSource{ m_pTexels[sourceIdx] };
+		float* pDestination{ m_pTexels[1 - sourceIdx] };
+		std::for_each( std::execution::par, m_Bands.begin( ), m_Bands.end( ),
+		[this, pass, pSource, pDestination, width, height]( int band )
+			{
+				FilterBand( band, 1 << pass, pSource, pDestination, width, height );
+			} );
+		sourceIdx = 1 - sourceIdx;
+	}
+
+	// Multiply back what was divided out
+	const float* pResult{ m_pTexels[sourceIdx] };
+	std::for_each( std::execution::par, m_Bands.begin( ), m_Bands.end( ),
+	[this, pResult, pColors, pSplits, width, height]( int band )
+		{
+			const float* pPlaneScales{ GetPlane( m_pGuides, PLANE_SCALE_PLANE ) };
+			const int end{ std::min( ( band + 1 ) * DENOISE_BAND_HEIGHT, height ) * width };
+			for ( int pixelIdx{ band * DENOISE_BAND_HEIGHT * width }; pixelIdx < end; ++pixelIdx )
+			{
+				if ( pPlaneScales[pixelIdx] <= 0.f )
+				{
+					m_pOutput[pixelIdx] = pColors[pixelIdx];
+					continue;
+				}
+
+				const LightingSplit& split{ pSplits[pixelIdx] };
+				const ColorRGB shadowRatio{ GetPlane( pResult, 0 )[pixelIdx], GetPlane( pResult, 1 )[pixelIdx], GetPlane( pResult, 2 )[pixelIdx] };
+				const ColorRGB indirect{ GetPlane( pResult, 4 )[pixelIdx], GetPlane( pResult, 5 )[pixelIdx], GetPlane( pResult, 6 )[pixelIdx] };
+				ColorRGB color{ split.unshadowedDirect * shadowRatio + GetDemodulationAlbedo( split.albedo ) * indirect };
+				color.MaxToOne( );
+				m_pOutput[pixelIdx] = color;
+			}
+		} );
+	return m_pOutput;
+}
+
+void Denoiser::Prepare( const LightingSplit* pSplits, const HitRecord* pPrimaryHits, int width, int height )
+{
+	float* pTexels{ m_pTexels[0] };
+	std::for_each( std::execution::par, m_Bands.begin( ), m_Bands.end( ),
+	[this, pTexels, pSplits, pPrimaryHits, width, height]( int band )
+		{
+			const int end{ std::min( ( band + 1 ) * DENOISE_BAND_HEIGHT, height ) * width };
+			for ( int pixelIdx{ band * DENOISE_BAND_HEIGHT * width }; pixelIdx < end; ++pixelIdx )
+			{
+				const LightingSplit& split{ pSplits[pixelIdx] };
+				const ColorRGB albedo{ GetDemodulationAlbedo( split.albedo ) };
+				const float texel[TEXEL_PLANES]{
+					GetShadowRatio( split.direct.r, split.unshadowedDirect.r ),
+					GetShadowRatio( split.direct.g, split.unshadowedDirect.g ),
+					GetShadowRatio( split.direct.b, split.unshadowedDirect.b ),
+					0.f,
+					split.indirect.r / albedo.r,
+					split.indirect.g / albedo.g,
+					split.indirect.b / albedo.b,
+					0.f };
+				for ( int plane{}; plane < TEXEL_PLANES; plane += 4 )
+				{
+					for ( int channel{}; channel < 3; ++channel )
+					{
+						GetPlane( pTexels, plane + channel )[pixelIdx] = texel[plane + channel];
+					}
+					GetPlane( pTexels, plane + 3 )[pixelIdx] = GetLuminance( texel[plane], texel[plane + 1], texel[plane + 2] );
+				}
+
+				// Pixels that are not filtered keep a zero normal and plane scale
+				const HitRecord& hitRecord{ pPrimaryHits[pixelIdx] };
+				const bool isFiltered{ split.isFiltered && hitRecord.didHit };
+				const Vector3 normal{ isFiltered ? hitRecord.normal : Vector3{} };
+				const Vector3 position{ isFiltered ? hitRecord.origin : Vector3{} };
+				GetPlane( m_pGuides, NORMAL_PLANE )[pixelIdx] = normal.x;
+				GetPlane( m_pGuides, NORMAL_PLANE + 1 )[pixelIdx] = normal.y;
+				GetPlane( m_pGuides, NORMAL_PLANE + 2 )[pixelIdx] = normal.z;
+				GetPlane( m_pGuides, POSITION_PLANE )[pixelIdx] = position.x;
+				GetPlane( m_pGuides, POSITION_PLANE + 1 )[pixelIdx] = position.y;
+				GetPlane( m_pGuides, POSITION_PLANE + 2 )[pixelIdx] = position.z;
+				GetPlane( m_pGuides, PLANE_SCALE_PLANE )[pixelIdx] = isFiltered ? 1.f / ( DENOISE_SIGMA_PLANE * hitRecord.t ) : 0.f;
+			}
+		} );
+
+	// The luminance edge stops are relative to the local noise level and mean, so noise itself is not mistaken for an edge
+	std::for_each( std::execution::par, m_Bands.begin( ), m_Bands.end( ),
+	[this, pTexels, width, height]( int band )
+		{
+			const float* pLuminances[2]{ GetPlane( pTexels, 3 ), GetPlane( pTexels, 7 ) };
+			const int bottom{ std::min( ( band + 1 ) * DENOISE_BAND_HEIGHT, height ) };
+			for ( int py{ band * DENOISE_BAND_HEIGHT }; py < bottom; ++py )
+			{
+				for ( int px{}; px < width; ++px )
+				{
+					const int pixelIdx{ px + py * width };
+					const float shadowRatio{ pLuminances[0][pixelIdx] };
+					float sums[2]{};
+					float squareSums[2]{};
+					int count{};
+					int agreeingCount{};
+					for ( int y{ std::max( py - 1, 0 ) }; y <= std::min( py + 1, height - 1 ); ++y )
+					{
+						for ( int x{ std::max( px - 1, 0 ) }; x <= std::min( px + 1, width - 1 ); ++x )
+						{
+							for ( int part{}; part < 2; ++part )
+							{
+								const float luminance{ pLuminances[part][x + y * width] };
+								sums[part] += luminance;
+								squareSums[part] += luminance * luminance;
+							}
+							agreeingCount += std::abs( pLuminances[0][x + y * width] - shadowRatio ) < DENOISE_SHADOW_TOLERANCE;
+							++count;
+						}
+					}
+
+					const bool isFiltered{ GetPlane( m_pGuides, PLANE_SCALE_PLANE )[pixelIdx] > 0.f };
+					for ( int part{}; part < 2; ++part )
+					{
+						const float mean{ sums[part] / count };
+						const float deviation{ sqrtf( std::max( 0.f, squareSums[part] / count - mean * mean ) ) };
+						const float sigma{ part ? DENOISE_SIGMA_INDIRECT : DENOISE_SIGMA_SHADOW };
+						GetPlane( m_pGuides, LUMINANCE_MEAN_PLANE + part )[pixelIdx] = mean;
+						// Zero where the part has nothing to filter
+						GetPlane( m_pGuides, LUMINANCE_SCALE_PLANE + part )[pixelIdx] =
+							isFiltered && deviation > DENOISE_MIN_DEVIATION ? 1.f / ( sigma * deviation ) : 0.f;
+					}
+
+					// At a single sample the shadow ratio jumps as much along a shadow edge as in its noise, only a pixel
+					// that agrees with none of its neighbours (besides itself) is taken for noise
+					if ( agreeingCount > 1 )
+					{
+						GetPlane( m_pGuides, LUMINANCE_SCALE_PLANE )[pixelIdx] = 0.f;
+					}
+				}
+			}
+		} );
+}
+
+void Denoiser::FilterBand( int band, int stepSize, const float* pSource, float* pDestination, int width, int height ) const
+{
+	const float* pNormals[3]{ GetPlane( m_pGuides, NORMAL_PLANE ), GetPlane( m_pGuides, NORMAL_PLANE + 1 ), GetPlane( m_pGuides, NORMAL_PLANE + 2 ) };
+	const float* pPositions[3]{ GetPlane( m_pGuides, POSITION_PLANE ), GetPlane( m_pGuides, POSITION_PLANE + 1 ), GetPlane( m_pGuides, POSITION_PLANE + 2 ) };
+	const Float8 laneOffsets{ Float8::Load( LANE_OFFSETS ) };
+	const Float8 centerWeight{ KERNEL[2] * KERNEL[2] };
+
+	const int bottom{ std::min( ( band + 1 ) * DENOISE_BAND_HEIGHT, height ) };
+	for ( int py{ band * DENOISE_BAND_HEIGHT }; py < bottom; ++py )
+	{
+		for ( int px{}; px < width; px += LANE_COUNT )
+		{
+			const int pixelIdx{ px + py * width };
+			const int laneCount{ std::min( LANE_COUNT, width - px ) };
+			// Both geometry stops come down to a dot product with the tap's normal or position
+			const Vector3x8 normal{ Float8::Load( pNormals[0] + pixelIdx ), Float8::Load( pNormals[1] + pixelIdx ), Float8::Load( pNormals[2] + pixelIdx ) };
+			const Vector3x8 position{ Float8::Load( pPositions[0] + pixelIdx ), Float8::Load( pPositions[1] + pixelIdx ), Float8::Load( pPositions[2] + pixelIdx ) };
+			const Vector3x8 sharpNormal{ normal * Float8{ DENOISE_NORMAL_SHARPNESS } };
+			const Vector3x8 planeNormal{ normal * Float8::Load( GetPlane( m_pGuides, PLANE_SCALE_PLANE ) + pixelIdx ) };
+			const Float8 planeOffset{ Vector3x8::Dot( planeNormal, position ) };
+
+			for ( int part{}; part < 2; ++part )
+			{
+				const float* pChannels[4];
+				float* pFilteredChannels[4];
+				Float8 channels[4];
+				for ( int channel{}; channel < 4; ++channel )
+				{
+					pChannels[channel] = GetPlane( pSource, part * 4 + channel );
+					pFilteredChannels[channel] = GetPlane( pDestination, part * 4 + channel );
+					channels[channel] = Float8::Load( pChannels[channel] + pixelIdx );
+				}
+
+				// Background, mirror or nothing noisy around, nothing to filter
+				const Float8 luminanceScale{ Float8::Load( GetPlane( m_pGuides, LUMINANCE_SCALE_PLANE + part ) + pixelIdx ) };
+				const Float8 isFiltered{ luminanceScale > Float8{ 0.f } };
+				if ( isFiltered.GetMask( ) == 0 )
+				{
+					for ( int channel{}; channel < 4; ++channel )
+					{
+						StoreLanes( channels[channel], pFilteredChannels[channel] + pixelIdx, laneCount );
+					}
+					continue;
+				}
+				const Float8 luminanceMean{ Float8::Load( GetPlane( m_pGuides, LUMINANCE_MEAN_PLANE + part ) + pixelIdx ) };
+
+				// The center tap always counts, the weights never add up to zero
+				Float8 sums[4];
+				for ( int channel{}; channel < 4; ++channel )
+				{
+					sums[channel] = channels[channel] * centerWeight;
+				}
+				Float8 weightSum{ centerWeight };
+
+				for ( int j{ -2 }; j <= 2; ++j )
+				{
+					const int y{ py + j * stepSize };
+					if ( y < 0 || y >= height )
+					{
+						continue;
+					}
+
+					for ( int i{ -2 }; i <= 2; ++i )
+					{
+						if ( i == 0 && j == 0 )
+						{
+							continue;
+						}
+
+						const int x{ px + i * stepSize };
+						const int tapIdx{ x + y * width };
+						const Vector3x8 tapNormal{ Float8::Load( pNormals[0] + tapIdx ), Float8::Load( pNormals[1] + tapIdx ), Float8::Load( pNormals[2] + tapIdx ) };
+						const Vector3x8 tapPosition{ Float8::Load( pPositions[0] + tapIdx ), Float8::Load( pPositions[1] + tapIdx ), Float8::Load( pPositions[2] + tapIdx ) };
+						Float8 tapChannels[4];
+						for ( int channel{}; channel < 4; ++channel )
+						{
+							tapChannels[channel] = Float8::Load( pChannels[channel] + tapIdx );
+						}
+
+						// Taps on another surface, facing another way or across a luminance edge hardly count
+						const Float8 exponent{
+							Float8{ DENOISE_NORMAL_SHARPNESS } - Vector3x8::Dot( sharpNormal, tapNormal )
+							+ Abs( Vector3x8::Dot( planeNormal, tapPosition ) - planeOffset )
+							+ Abs( luminanceMean - tapChannels[3] ) * luminanceScale };
+						Float8 weight{ GetEdgeWeight( exponent ) * Float8{ KERNEL[i + 2] * KERNEL[j + 2] } };
+						// Lanes whose tap falls off the frame read another row or the padding, they get no weight
+						if ( x < 0 || x + LANE_COUNT > width )
+						{
+							const Float8 tapX{ laneOffsets + Float8{ float( x ) } };
+							weight = weight & ( tapX > Float8{ -1.f } ) & ( tapX < Float8{ float( width ) } );
+						}
+						for ( int channel{}; channel < 4; ++channel )
+						{
+							sums[channel] = Float8::MultiplyAdd( tapChannels[channel], weight, sums[channel] );
+						}
+						weightSum += weight;
+					}
+				}
+
+				const Float8 inverseWeightSum{ Float8{ 1.f } / weightSum };
+				for ( int channel{}; channel < 4; ++channel )
+				{
+					StoreLanes( Float8::Select( isFiltered, sums[channel] * inverseWeightSum, channels[channel] ), pFilteredChannels[channel] + pixelIdx, laneCount );
+				}
+			}
+		}
+	}
+}
+
+float* Denoiser::GetPlane( float* pPlanes, int plane ) const
+{
+	return pPlanes + plane * m_PlaneSize + PLANE_PADDING;
+}
+
+const float* Denoiser::GetPlane( const float* pPlanes, int plane ) const
+{
+	return pPlanes + plane * m_PlaneSize + PLANE_PADDING;
+}
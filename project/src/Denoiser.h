@@ -0,0 +1,56 @@
+#pragma once
+
+//Standard includes
+#include <cstdint>
+#include <vector>
+
+//Project includes
+#include "DataTypes.h"
+
+namespace dae
+{
+	/**
+	 * \brief Edge-aware à-trous wavelet filter for low sample soft shadows and global illumination.
+	 * Only the noisy parts of the lighting are filtered, divided by what is known without noise: the direct light as a
+	 * ratio of its unshadowed value, the indirect light without the albedo. Both are multiplied back afterwards, so
+	 * facets, material edges and shadow free lighting keep exactly their traced values.
+	 * Every pass blurs with a 5x5 kernel whose taps spread twice as far as in the pass before, so a few passes
+	 * cover a wide footprint. Taps off the pixel's surface, facing another way or across a strong luminance edge
+	 * lose their weight, and pixels without noise around them are left alone. Eight pixels in a row are filtered
+	 * at once, one per SIMD lane.
+	 */
+	class Denoiser final
+	{
+	public:
+		// Buffers are sized for the largest frame, smaller (scaled) frames use a part of them
+		explicit Denoiser( uint32_t maxPixelCount );
+		~Denoiser( );
+
+		Denoiser( const Denoiser& ) = delete;
+		Denoiser( Denoiser&& ) noexcept = delete;
+		Denoiser& operator=( const Denoiser& ) = delete;
+		Denoiser& operator=( Denoiser&& ) noexcept = delete;
+
+		// Filters the lighting of every pixel, guided by its primary hit. Returns the filtered frame,
+		// owned by the denoiser and valid until the next call. The inputs are left untouched.
+		const ColorRGB* Denoise( const ColorRGB* pColors, const LightingSplit* pSplits, const HitRecord* pPrimaryHits, int width, int height );
+
+	private:
+		// Every buffer holds planes of one float per pixel, so eight pixels in a row load at once
+		int m_PlaneSize{};
+		// Normal, position and plane stop scale of every pixel's primary hit, then per part the local luminance mean
+		// and stop scale. Background, mirrors and reconstructed pixels have no normal, they never weigh in as a tap
+		float* m_pGuides{};
+		// Ping-pong buffers, r g b and luminance planes of the shadow ratio, then of the indirect light
+		float* m_pTexels[2]{};
+		ColorRGB* m_pOutput{};
+
+		std::vector<int> m_Bands{};
+
+		void Prepare( const LightingSplit* pSplits, const HitRecord* pPrimaryHits, int width, int height );
+		void FilterBand( int band, int stepSize, const float* pSource, float* pDestination, int width, int height ) const;
+
+		float* GetPlane( float* pPlanes, int plane ) const;
+		const float* GetPlane( const float* pPlanes, int plane ) const;
+	};
+}
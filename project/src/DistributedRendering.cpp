@@ -0,0 +1,589 @@
+#include "DistributedRendering.h"
+
+//External includes
+#include "SDL.h"
+#include "SDL_surface.h"
+
+//Standard includes
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include <utility>
+
+//Project includes
+#include "Renderer.h"
+#include "Scene.h"
+#include "Timer.h"
+
+// Tiles sent ahead per worker, so it never idles while a result travels back
+#define TILES_IN_FLIGHT 2
+// A tile out for this many times the average tile time counts as stuck
+#define SLOW_TILE_FACTOR 4.f
+#define MAX_TILE_COPIES 2
+
+#define CONNECT_ATTEMPTS 50
+#define CONNECT_RETRY_MS 100
+
+using namespace dae;
+
+namespace
+{
+	// Messages are a header followed by a fixed payload, every field is 4 bytes wide so nothing is padded.
+	// Fields are sent in host byte order, coordinator and workers are expected to share one.
+	constexpr uint32_t PROTOCOL_VERSION{ 1 };
+
+	enum class MessageType : uint32_t
+	{
+		Setup,	// coordinator -> worker: SetupMessage
+		Ready,	// worker -> coordinator: scene loaded
+		Tile,	// coordinator -> worker: TileMessage
+		Pixels,	// worker -> coordinator: PixelsMessage, then 3 bytes (r g b) per pixel, row by row
+		Finish	// coordinator -> worker: frame done
+	};
+
+	struct MessageHeader
+	{
+		MessageType type{};
+		uint32_t size{};
+	};
+
+	struct SetupMessage
+	{
+		uint32_t version{ PROTOCOL_VERSION };
+		uint32_t sceneIdx{};
+		int32_t width{};
+		int32_t height{};
+		int32_t lightingMode{};
+		int32_t shadowMode{};
+		int32_t globalIllumination{};
+	};
+
+	struct TileMessage
+	{
+		uint32_t tileIdx{};
+		int32_t left{};
+		int32_t top{};
+		int32_t right{};
+		int32_t bottom{};
+
+		float sceneTime{};
+		float cameraOrigin[3]{};
+		float cameraPitch{};
+		float cameraYaw{};
+		float cameraFovAngle{};
+	};
+
+	struct PixelsMessage
+	{
+		uint32_t tileIdx{};
+		uint32_t pixelCount{};
+	};
+
+	bool SendPacket( const Socket& socket, MessageType type, const void* pPayload = nullptr, uint32_t size = 0 )
+	{
+		const MessageHeader header{ type, size };
+		return socket.SendAll( &header, sizeof( header ) ) && ( size == 0 || socket.SendAll( pPayload, size ) );
+	}
+
+	// Receives the payload of a message with a known layout, anything else is a protocol error
+	template<typename Payload>
+	bool ReceivePayload( const Socket& socket, const MessageHeader& header, Payload& payload )
+	{
+		return header.size == sizeof( Payload ) && socket.ReceiveAll( &payload, sizeof( Payload ) );
+	}
+}
+
+#pragma region Coordinator
+RenderCoordinator::RenderCoordinator( std::vector<std::function<Scene*( )>> sceneFactories, const DistributedSettings& settings ) :
+	m_SceneFactories{ std::move( sceneFactories ) },
+	m_Settings{ settings }
+{
+}
+
+RenderCoordinator::~RenderCoordinator( )
+{
+	SDL_FreeSurface( m_pFrame );
+}
+
+bool RenderCoordinator::Run( )
+{
+	if ( m_Settings.sceneIdx >= m_SceneFactories.size( ) )
+	{
+		std::cout << ">> Scene " << m_Settings.sceneIdx << " does not exist" << std::endl;
+		return false;
+	}
+	ReadCamera( );
+	if ( !AcceptWorkers( ) )
+	{
+		return false;
+	}
+
+	m_pFrame = SDL_CreateRGBSurfaceWithFormat( 0, m_Settings.width, m_Settings.height, 32, SDL_PIXELFORMAT_ARGB8888 );
+	CreateTiles( );
+	m_WorkerTileCounts.assign( m_Workers.size( ), 0 );
+	m_ActiveWorkerCount = uint32_t( m_Workers.size( ) );
+
+	std::cout << "**DISTRIBUTED RENDER STARTED** " << m_Settings.width << "x" << m_Settings.height
+		<< ", " << m_Tiles.size( ) << " tiles, " << m_Workers.size( ) << " workers\n";
+	const Clock::time_point start{ Clock::now( ) };
+
+	std::vector<std::thread> threads{};
+	threads.reserve( m_Workers.size( ) );
+	for ( int workerIdx{}; workerIdx < int( m_Workers.size( ) ); ++workerIdx )
+	{
+		threads.emplace_back( &RenderCoordinator::ServeWorker, this, workerIdx );
+	}
+
+	bool isDone{};
+	{
+		std::unique_lock lock{ m_Mutex };
+		m_Changed.wait( lock, [this]( ) { return IsFrameDone( ) || m_ActiveWorkerCount == 0; } );
+		isDone = IsFrameDone( );
+	}
+
+	// Wakes the threads still waiting on a copy of a tile that is already done
+	for ( const Socket& worker : m_Workers )
+	{
+		worker.Shutdown( );
+	}
+	for ( std::thread& thread : threads )
+	{
+		thread.join( );
+	}
+
+	if ( !isDone )
+	{
+		std::cout << ">> Every worker disconnected, " << m_DoneTileCount << "/" << m_Tiles.size( ) << " tiles done" << std::endl;
+		return false;
+	}
+
+	const double seconds{ std::chrono::duration<double>( Clock::now( ) - start ).count( ) };
+	std::cout << "**DISTRIBUTED RENDER FINISHED** in " << seconds * 1000.0 << "ms, "
+		<< m_ReassignedTileCount << " tiles reassigned\n";
+	for ( size_t workerIdx{}; workerIdx < m_WorkerTileCounts.size( ); ++workerIdx )
+	{
+		std::cout << ">> Worker " << workerIdx << ": " << m_WorkerTileCounts[workerIdx] << " tiles\n";
+	}
+
+	if ( SDL_SaveBMP( m_pFrame, m_Settings.outputPath.c_str( ) ) != 0 )
+	{
+		std::cout << "Something went wrong. Frame not saved!" << std::endl;
+		return false;
+	}
+	std::cout << "Frame saved to " << m_Settings.outputPath << "!" << std::endl;
+	return true;
+}
+
+bool RenderCoordinator::AcceptWorkers( )
+{
+	if ( !m_Listener.Listen( m_Settings.port ) )
+	{
+		std::cout << ">> Could not listen on port " << m_Settings.port << std::endl;
+		return false;
+	}
+
+	std::cout << ">> Waiting for " << m_Settings.workerCount << " workers on port " << m_Settings.port << std::endl;
+	while ( m_Workers.size( ) < m_Settings.workerCount )
+	{
+		Socket worker{ m_Listener.Accept( ) };
+		if ( !worker.IsValid( ) )
+		{
+			std::cout << ">> Accepting a worker failed" << std::endl;
+			return false;
+		}
+		m_Workers.push_back( std::move( worker ) );
+		std::cout << ">> Worker " << m_Workers.size( ) - 1 << " connected" << std::endl;
+	}
+	m_Listener.Close( );
+	return true;
+}
+
+void RenderCoordinator::ReadCamera( )
+{
+	// The frame is seen through the camera the scene starts with, animated to the frame time like on the workers
+	Scene* pScene{ m_SceneFactories[m_Settings.sceneIdx]( ) };
+	pScene->Initialize( );
+	if ( m_Settings.sceneTime > 0.f )
+	{
+		Timer timer{};
+		timer.SetFixedTimeStep( m_Settings.sceneTime );
+		timer.Reset( );
+		timer.Update( );
+		pScene->Update( &timer );
+	}
+
+	const Camera& camera{ pScene->GetCamera( ) };
+	m_CameraOrigin[0] = camera.origin.x;
+	m_CameraOrigin[1] = camera.origin.y;
+	m_CameraOrigin[2] = camera.origin.z;
+	m_CameraPitch = camera.totalPitch;
+	m_CameraYaw = camera.totalYaw;
+	m_CameraFovAngle = camera.fovAngle;
+
+	std::cout << ">> Rendering " << pScene->GetSceneName( ) << std::endl;
+	delete pScene;
+}
+
+void RenderCoordinator::CreateTiles( )
+{
+	m_Tiles.clear( );
+	for ( int top{}; top < m_Settings.height; top += m_Settings.tileSize )
+	{
+		for ( int left{}; left < m_Settings.width; left += m_Settings.tileSize )
+		{
+			Tile tile{};
+			tile.left = left;
+			tile.top = top;
+			tile.right = std::min( left + m_Settings.tileSize, m_Settings.width );
+			tile.bottom = std::min( top + m_Settings.tileSize, m_Settings.height );
+			m_Tiles.push_back( tile );
+		}
+	}
+}
+
+void RenderCoordinator::ServeWorker( int workerIdx )
+{
+	const Socket& worker{ m_Workers[workerIdx] };
+
+	SetupMessage setup{};
+	setup.sceneIdx = m_Settings.sceneIdx;
+	setup.width = m_Settings.width;
+	setup.height = m_Settings.height;
+	setup.lightingMode = m_Settings.lightingMode;
+	setup.shadowMode = m_Settings.shadowMode;
+	setup.globalIllumination = m_Settings.globalIllumination;
+
+	MessageHeader header{};
+	bool isConnected{ SendPacket( worker, MessageType::Setup, &setup, sizeof( setup ) )
+		&& worker.ReceiveAll( &header, sizeof( header ) )
+		&& header.type == MessageType::Ready };
+
+	std::vector<uint32_t> inFlight{};
+	std::vector<uint8_t> pixels{};
+	while ( isConnected )
+	{
+		uint32_t tileIdx{};
+		while ( inFlight.size( ) < TILES_IN_FLIGHT && TryAcquireTile( workerIdx, tileIdx ) )
+		{
+			inFlight.push_back( tileIdx );
+
+			const Tile& tile{ m_Tiles[tileIdx] };
+			TileMessage message{};
+			message.tileIdx = tileIdx;
+			message.left = tile.left;
+			message.top = tile.top;
+			message.right = tile.right;
+			message.bottom = tile.bottom;
+			message.sceneTime = m_Settings.sceneTime;
+			std::copy_n( m_CameraOrigin, 3, message.cameraOrigin );
+			message.cameraPitch = m_CameraPitch;
+			message.cameraYaw = m_CameraYaw;
+			message.cameraFovAngle = m_CameraFovAngle;
+			if ( !SendPacket( worker, MessageType::Tile, &message, sizeof( message ) ) )
+			{
+				isConnected = false;
+				break;
+			}
+		}
+		if ( !isConnected )
+		{
+			break;
+		}
+
+		if ( inFlight.empty( ) )
+		{
+			// Nothing to do until a worker drops out or a tile falls behind
+			std::unique_lock lock{ m_Mutex };
+			if ( IsFrameDone( ) )
+			{
+				break;
+			}
+			m_Changed.wait_for( lock, std::chrono::milliseconds( 50 ) );
+			continue;
+		}
+
+		PixelsMessage result{};
+		if ( !worker.ReceiveAll( &header, sizeof( header ) )
+			|| header.type != MessageType::Pixels
+			|| !worker.ReceiveAll( &result, sizeof( result ) ) )
+		{
+			isConnected = false;
+			break;
+		}
+
+		const auto resultIt{ std::find( inFlight.begin( ), inFlight.end( ), result.tileIdx ) };
+		const Tile* pTile{ resultIt != inFlight.end( ) ? &m_Tiles[result.tileIdx] : nullptr };
+		if ( !pTile
+			|| result.pixelCount != uint32_t( ( pTile->right - pTile->left ) * ( pTile->bottom - pTile->top ) )
+			|| header.size != sizeof( result ) + result.pixelCount * 3 )
+		{
+			std::cout << ">> Worker " << workerIdx << " sent an unexpected tile, dropping it" << std::endl;
+			isConnected = false;
+			break;
+		}
+
+		pixels.resize( result.pixelCount * 3 );
+		if ( !worker.ReceiveAll( pixels.data( ), pixels.size( ) ) )
+		{
+			isConnected = false;
+			break;
+		}
+		CompleteTile( workerIdx, result.tileIdx, pixels.data( ) );
+		inFlight.erase( resultIt );
+	}
+
+	bool isDone{};
+	{
+		std::lock_guard lock{ m_Mutex };
+		ReleaseTiles( inFlight );
+		--m_ActiveWorkerCount;
+		isDone = IsFrameDone( );
+	}
+	m_Changed.notify_all( );
+
+	if ( isDone )
+	{
+		SendPacket( worker, MessageType::Finish );
+	}
+	else
+	{
+		std::cout << ">> Worker " << workerIdx << " disconnected, its tiles go back to the queue" << std::endl;
+	}
+}
+
+bool RenderCoordinator::TryAcquireTile( int workerIdx, uint32_t& tileIdx )
+{
+	std::lock_guard lock{ m_Mutex };
+	const Clock::time_point now{ Clock::now( ) };
+
+	const auto pendingIt{ std::find_if( m_Tiles.begin( ), m_Tiles.end( ), []( const Tile& tile ) { return tile.state == TileState::Pending; } ) };
+	if ( pendingIt != m_Tiles.end( ) )
+	{
+		pendingIt->state = TileState::Assigned;
+		pendingIt->copies = 1;
+		pendingIt->lastWorkerIdx = workerIdx;
+		pendingIt->assignedAt = now;
+		tileIdx = uint32_t( pendingIt - m_Tiles.begin( ) );
+		return true;
+	}
+
+	// Without finished tiles there is no average to call a tile slow against
+	if ( m_DoneTileCount == 0 )
+	{
+		return false;
+	}
+
+	// Give the tile that has been out the longest to this worker too, when it is far behind the average
+	const double slowSeconds{ SLOW_TILE_FACTOR * m_TileSecondsSum / m_DoneTileCount };
+	Tile* pSlowest{};
+	for ( Tile& tile : m_Tiles )
+	{
+		if ( tile.state == TileState::Assigned && tile.copies < MAX_TILE_COPIES && tile.lastWorkerIdx != workerIdx
+			&& ( !pSlowest || tile.assignedAt < pSlowest->assignedAt ) )
+		{
+			pSlowest = &tile;
+		}
+	}
+	if ( !pSlowest || std::chrono::duration<double>( now - pSlowest->assignedAt ).count( ) < slowSeconds )
+	{
+		return false;
+	}
+
+	++pSlowest->copies;
+	pSlowest->lastWorkerIdx = workerIdx;
+	++m_ReassignedTileCount;
+	tileIdx = uint32_t( pSlowest - m_Tiles.data( ) );
+	return true;
+}
+
+bool RenderCoordinator::CompleteTile( int workerIdx, uint32_t tileIdx, const uint8_t* pPixels )
+{
+	{
+		std::lock_guard lock{ m_Mutex };
+		Tile& tile{ m_Tiles[tileIdx] };
+		if ( tile.state == TileState::Done )
+		{
+			return false;
+		}
+
+		uint32_t* pFramePixels{ static_cast<uint32_t*>( m_pFrame->pixels ) };
+		const int framePitch{ m_pFrame->pitch / int( sizeof( uint32_t ) ) };
+		for ( int py{ tile.top }; py < tile.bottom; ++py )
+		{
+			for ( int px{ tile.left }; px < tile.right; ++px, pPixels += 3 )
+			{
+				pFramePixels[px + py * framePitch] = SDL_MapRGB( m_pFrame->format, pPixels[0], pPixels[1], pPixels[2] );
+			}
+		}
+
+		tile.state = TileState::Done;
+		tile.copies = 0;
+		m_TileSecondsSum += std::chrono::duration<double>( Clock::now( ) - tile.assignedAt ).count( );
+		++m_DoneTileCount;
+		++m_WorkerTileCounts[workerIdx];
+	}
+	m_Changed.notify_all( );
+	return true;
+}
+
+void RenderCoordinator::ReleaseTiles( const std::vector<uint32_t>& tileIndices )
+{
+	for ( const uint32_t tileIdx : tileIndices )
+	{
+		Tile& tile{ m_Tiles[tileIdx] };
+		if ( tile.state != TileState::Assigned )
+		{
+			continue;
+		}
+
+		// Another worker may still deliver a copy
+		if ( --tile.copies == 0 )
+		{
+			tile.state = TileState::Pending;
+			tile.lastWorkerIdx = -1;
+		}
+	}
+}
+#pragma endregion
+
+#pragma region Worker
+RenderWorker::RenderWorker( std::vector<std::function<Scene*( )>> sceneFactories, const DistributedSettings& settings ) :
+	m_SceneFactories{ std::move( sceneFactories ) },
+	m_Settings{ settings }
+{
+}
+
+RenderWorker::~RenderWorker( )
+{
+	delete m_pRenderer;
+	delete m_pScene;
+}
+
+bool RenderWorker::Run( )
+{
+	if ( !Connect( ) || !Setup( ) )
+	{
+		return false;
+	}
+
+	std::vector<uint32_t> tilePixels{};
+	std::vector<uint8_t> packedPixels{};
+	uint32_t tileCount{};
+	while ( true )
+	{
+		MessageHeader header{};
+		if ( !m_Socket.ReceiveAll( &header, sizeof( header ) ) || header.type == MessageType::Finish )
+		{
+			break;
+		}
+
+		TileMessage tile{};
+		if ( header.type != MessageType::Tile || !ReceivePayload( m_Socket, header, tile )
+			|| tile.left < 0 || tile.top < 0 || tile.right > m_pRenderer->GetWidth( ) || tile.bottom > m_pRenderer->GetHeight( )
+			|| tile.left >= tile.right || tile.top >= tile.bottom )
+		{
+			std::cout << ">> Unexpected message from the coordinator" << std::endl;
+			return false;
+		}
+
+		ApplyFrameState( tile.sceneTime, tile.cameraOrigin, tile.cameraPitch, tile.cameraYaw, tile.cameraFovAngle );
+
+		const uint32_t pixelCount{ uint32_t( ( tile.right - tile.left ) * ( tile.bottom - tile.top ) ) };
+		tilePixels.resize( pixelCount );
+		m_pRenderer->RenderRegion( m_pScene, tile.left, tile.top, tile.right, tile.bottom, tilePixels.data( ) );
+
+		// The headless buffer is ARGB8888, alpha is not sent
+		packedPixels.resize( pixelCount * 3 );
+		for ( uint32_t pixelIdx{}; pixelIdx < pixelCount; ++pixelIdx )
+		{
+			const uint32_t pixel{ tilePixels[pixelIdx] };
+			packedPixels[pixelIdx * 3] = uint8_t( pixel >> 16 );
+			packedPixels[pixelIdx * 3 + 1] = uint8_t( pixel >> 8 );
+			packedPixels[pixelIdx * 3 + 2] = uint8_t( pixel );
+		}
+
+		const PixelsMessage result{ tile.tileIdx, pixelCount };
+		const MessageHeader resultHeader{ MessageType::Pixels, uint32_t( sizeof( result ) + packedPixels.size( ) ) };
+		if ( !m_Socket.SendAll( &resultHeader, sizeof( resultHeader ) )
+			|| !m_Socket.SendAll( &result, sizeof( result ) )
+			|| !m_Socket.SendAll( packedPixels.data( ), packedPixels.size( ) ) )
+		{
+			break;
+		}
+		++tileCount;
+	}
+
+	// A closed connection also ends the frame, the coordinator drops workers it no longer needs
+	std::cout << "**WORKER FINISHED** " << tileCount << " tiles rendered" << std::endl;
+	return true;
+}
+
+bool RenderWorker::Connect( )
+{
+	// Workers may start before the coordinator listens
+	for ( int attempt{}; attempt < CONNECT_ATTEMPTS; ++attempt )
+	{
+		if ( m_Socket.Connect( m_Settings.host, m_Settings.port ) )
+		{
+			std::cout << ">> Connected to " << m_Settings.host << ":" << m_Settings.port << std::endl;
+			return true;
+		}
+		std::this_thread::sleep_for( std::chrono::milliseconds( CONNECT_RETRY_MS ) );
+	}
+
+	std::cout << ">> Could not connect to " << m_Settings.host << ":" << m_Settings.port << std::endl;
+	return false;
+}
+
+bool RenderWorker::Setup( )
+{
+	MessageHeader header{};
+	SetupMessage setup{};
+	if ( !m_Socket.ReceiveAll( &header, sizeof( header ) ) || header.type != MessageType::Setup
+		|| !ReceivePayload( m_Socket, header, setup ) )
+	{
+		std::cout << ">> No setup received from the coordinator" << std::endl;
+		return false;
+	}
+	if ( setup.version != PROTOCOL_VERSION || setup.sceneIdx >= m_SceneFactories.size( ) || setup.width <= 0 || setup.height <= 0 )
+	{
+		std::cout << ">> The coordinator asked for an unsupported setup" << std::endl;
+		return false;
+	}
+
+	m_pScene = m_SceneFactories[setup.sceneIdx]( );
+	m_pScene->Initialize( );
+	m_SceneTime = 0.f;
+
+	m_pRenderer = new Renderer( setup.width, setup.height );
+	m_pRenderer->SetLightingMode( LightingMode( setup.lightingMode ) );
+	m_pRenderer->SetShadowMode( ShadowMode( setup.shadowMode ) );
+	m_pRenderer->SetGlobalIllumination( setup.globalIllumination != 0 );
+
+	std::cout << ">> Loaded " << m_pScene->GetSceneName( ) << ", " << setup.width << "x" << setup.height << std::endl;
+	return SendPacket( m_Socket, MessageType::Ready );
+}
+
+void RenderWorker::ApplyFrameState( float sceneTime, const float origin[3], float pitch, float yaw, float fovAngle )
+{
+	Camera& camera{ m_pScene->GetCamera( ) };
+	if ( sceneTime != m_SceneTime )
+	{
+		Timer timer{};
+		timer.SetFixedTimeStep( sceneTime );
+		timer.Reset( );
+		timer.Update( );
+		m_pScene->Update( &timer );
+		m_SceneTime = sceneTime;
+	}
+
+	camera.origin = { origin[0], origin[1], origin[2] };
+	camera.totalPitch = pitch;
+	camera.totalYaw = yaw;
+	camera.ApplyCameraRotations( );
+	if ( fovAngle != camera.fovAngle )
+	{
+		m_pScene->ChangeCameraFov( fovAngle );
+	}
+}
+#pragma endregion
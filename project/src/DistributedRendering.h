@@ -0,0 +1,157 @@
+#pragma once
+
+//Standard includes
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//Project includes
+#include "Socket.h"
+
+struct SDL_Surface;
+
+namespace dae
+{
+	class Scene;
+	class Renderer;
+
+	struct DistributedSettings
+	{
+		std::string host{ "127.0.0.1" };
+		uint16_t port{ 5555 };
+
+		// Coordinator only, the workers receive everything below with the setup message
+		uint32_t workerCount{ 2 };
+		uint32_t sceneIdx{};
+		int width{ 1920 };
+		int height{ 1080 };
+		int tileSize{ 64 };
+		// Animation time the scene is updated to, 0 keeps it as initialized
+		float sceneTime{};
+		int lightingMode{ 3 };
+		int shadowMode{};
+		bool globalIllumination{ false };
+		std::string outputPath{ "distributed.bmp" };
+	};
+
+	/**
+	 * \brief Splits one frame into tiles and hands them out to render workers over TCP. Every worker keeps a
+	 * couple of tiles in flight and gets the next one as soon as a result comes back, so faster machines
+	 * take more of the frame. Once nothing is left to hand out, tiles that are taking much longer than the
+	 * average are handed to an idle worker as well and the first result wins. The tiles of a worker that
+	 * disconnects go back to the queue.
+	 */
+	class RenderCoordinator final
+	{
+	public:
+		RenderCoordinator( std::vector<std::function<Scene*( )>> sceneFactories, const DistributedSettings& settings );
+		~RenderCoordinator( );
+
+		RenderCoordinator( const RenderCoordinator& ) = delete;
+		RenderCoordinator( RenderCoordinator&& ) noexcept = delete;
+		RenderCoordinator& operator=( const RenderCoordinator& ) = delete;
+		RenderCoordinator& operator=( RenderCoordinator&& ) noexcept = delete;
+
+		// Waits for the workers, renders the frame and saves it. Returns false if the frame could not be finished.
+		bool Run( );
+
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		enum class TileState
+		{
+			Pending,
+			Assigned,
+			Done
+		};
+
+		struct Tile
+		{
+			int left{};
+			int top{};
+			int right{};
+			int bottom{};
+
+			TileState state{ TileState::Pending };
+			// Workers currently tracing it, more than one once it was reassigned
+			uint32_t copies{};
+			int lastWorkerIdx{ -1 };
+			Clock::time_point assignedAt{};
+		};
+
+		std::vector<std::function<Scene*( )>> m_SceneFactories;
+		DistributedSettings m_Settings;
+
+		Socket m_Listener{};
+		std::vector<Socket> m_Workers{};
+
+		std::mutex m_Mutex{};
+		std::condition_variable m_Changed{};
+		std::vector<Tile> m_Tiles{};
+		uint32_t m_DoneTileCount{};
+		uint32_t m_ActiveWorkerCount{};
+		uint32_t m_ReassignedTileCount{};
+		double m_TileSecondsSum{};
+		std::vector<uint32_t> m_WorkerTileCounts{};
+
+		// Assembled frame
+		SDL_Surface* m_pFrame{};
+
+		// Sent with every tile
+		float m_CameraOrigin[3]{};
+		float m_CameraPitch{};
+		float m_CameraYaw{};
+		float m_CameraFovAngle{};
+
+		bool AcceptWorkers( );
+		void ReadCamera( );
+		void CreateTiles( );
+		void ServeWorker( int workerIdx );
+
+		// Next pending tile, or a copy of a straggler once nothing is pending
+		bool TryAcquireTile( int workerIdx, uint32_t& tileIdx );
+		// Returns false when another worker already delivered the tile
+		bool CompleteTile( int workerIdx, uint32_t tileIdx, const uint8_t* pPixels );
+		// Puts the unfinished tiles of a lost worker back in the queue
+		void ReleaseTiles( const std::vector<uint32_t>& tileIndices );
+		bool IsFrameDone( ) const { return m_DoneTileCount == m_Tiles.size( ); }
+	};
+
+	/**
+	 * \brief Headless render process for distributed rendering. It loads the scene the coordinator asks for,
+	 * then traces every tile it receives with the camera state sent along and streams back the packed pixels,
+	 * until the coordinator finishes or closes the connection.
+	 */
+	class RenderWorker final
+	{
+	public:
+		RenderWorker( std::vector<std::function<Scene*( )>> sceneFactories, const DistributedSettings& settings );
+		~RenderWorker( );
+
+		RenderWorker( const RenderWorker& ) = delete;
+		RenderWorker( RenderWorker&& ) noexcept = delete;
+		RenderWorker& operator=( const RenderWorker& ) = delete;
+		RenderWorker& operator=( RenderWorker&& ) noexcept = delete;
+
+		// Returns false if the connection or the setup failed
+		bool Run( );
+
+	private:
+		std::vector<std::function<Scene*( )>> m_SceneFactories;
+		DistributedSettings m_Settings;
+
+		Socket m_Socket{};
+		Scene* m_pScene{};
+		Renderer* m_pRenderer{};
+		float m_SceneTime{};
+
+		bool Connect( );
+		bool Setup( );
+		// Animates the scene to the frame time when it changed, then places the camera
+		void ApplyFrameState( float sceneTime, const float origin[3], float pitch, float yaw, float fovAngle );
+	};
+}
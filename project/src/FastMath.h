@@ -0,0 +1,112 @@
+#pragma once
+
+//Standard includes
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+//Project includes
+#include "MathHelpers.h"
+#include "SIMD.h"
+
+// Swaps sin and cos in the sampling code for the approximations below
+#define USE_FAST_MATH
+
+namespace dae
+{
+	/**
+	 * \brief Approximations of the math functions the tracer calls per sample, and switches between them and the exact ones.
+	 * The approximations are always compiled, so their error can be tested whatever USE_FAST_MATH says.
+	 */
+	namespace FastMath
+	{
+		// 1 / sqrt(x) from the hardware estimate (12 bits) and one Newton step, within 5e-7 of the exact value relatively.
+		// Vector3::Normalize keeps its sqrt and divisions, they pipeline as well as this on current CPUs
+		inline float RSqrtApprox( float x )
+		{
+#ifdef MATH_USE_SSE
+			const float estimate{ _mm_cvtss_f32( _mm_rsqrt_ss( _mm_set_ss( x ) ) ) };
+			return estimate * ( 1.5f - .5f * x * estimate * estimate );
+#else
+			// Without SSE the estimate comes from the exponent bits, two steps bring it within 5e-6
+			float estimate{ std::bit_cast<float>( 0x5f375a86u - ( std::bit_cast<uint32_t>( x ) >> 1 ) ) };
+			estimate *= 1.5f - .5f * x * estimate * estimate;
+			return estimate * ( 1.5f - .5f * x * estimate * estimate );
+#endif
+		}
+
+		// sin(x) and cos(x) together through the polynomials of Cephes' sinf and cosf, within 5e-7 for angles up to a few turns
+		inline void SinCosApprox( float x, float& sine, float& cosine )
+		{
+			// Nearest quarter turn, what remains lies in [-PI/4, PI/4]
+			const int quarterTurns{ int( x * ( 2.f / PI ) + ( x < 0.f ? -.5f : .5f ) ) };
+			// PI/2 in three parts (Cody-Waite), the first ones multiply exactly so many turns don't lose precision
+			const float turns{ float( quarterTurns ) };
+			const float r{ ( ( x - turns * 1.5703125f ) - turns * 4.837512969970703125e-4f ) - turns * 7.54978995489188216e-8f };
+			const float r2{ r * r };
+			const float s{ r + r * r2 * ( -1.6666654611e-1f + r2 * ( 8.3321608736e-3f + r2 * -1.9515295891e-4f ) ) };
+			const float c{ 1.f - .5f * r2 + r2 * r2 * ( 4.166664568298827e-2f + r2 * ( -1.388731625493765e-3f + r2 * 2.443315711809948e-5f ) ) };
+
+			// Every quarter turn rotates (cos, sin) by 90 degrees
+			const bool isOddQuarter{ ( quarterTurns & 1 ) != 0 };
+			sine = isOddQuarter ? c : s;
+			cosine = isOddQuarter ? -s : c;
+			if ( quarterTurns & 2 )
+			{
+				sine = -sine;
+				cosine = -cosine;
+			}
+		}
+
+		inline float SinApprox( float x )
+		{
+			float sine, cosine;
+			SinCosApprox( x, sine, cosine );
+			return sine;
+		}
+
+		inline float CosApprox( float x )
+		{
+			float sine, cosine;
+			SinCosApprox( x, sine, cosine );
+			return cosine;
+		}
+
+		inline float RSqrt( float x )
+		{
+#ifdef USE_FAST_MATH
+			return RSqrtApprox( x );
+#else
+			return 1.f / sqrtf( x );
+#endif
+		}
+
+		inline void SinCos( float x, float& sine, float& cosine )
+		{
+#ifdef USE_FAST_MATH
+			SinCosApprox( x, sine, cosine );
+#else
+			sine = sinf( x );
+			cosine = cosf( x );
+#endif
+		}
+
+		inline float Sin( float x )
+		{
+#ifdef USE_FAST_MATH
+			return SinApprox( x );
+#else
+			return sinf( x );
+#endif
+		}
+
+		inline float Cos( float x )
+		{
+#ifdef USE_FAST_MATH
+			return CosApprox( x );
+#else
+			return cosf( x );
+#endif
+		}
+	}
+}
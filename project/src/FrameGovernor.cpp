@@ -0,0 +1,106 @@
+#include "FrameGovernor.h"
+
+//Standard includes
+#include <algorithm>
+#include <climits>
+#include <iterator>
+
+//Project includes
+#include "Renderer.h"
+
+using namespace dae;
+
+namespace
+{
+	struct QualityLevel
+	{
+		float renderScale;
+		int shadowSamples;
+		int indirectSamples;
+	};
+
+	// Sample counts are upper bounds on the renderer's own counts
+	constexpr int FULL_SAMPLES{ INT_MAX };
+
+	// From full quality down, each step roughly takes a third off the frame cost
+	constexpr QualityLevel QUALITY_LEVELS[]{
+		{ 1.f, FULL_SAMPLES, FULL_SAMPLES },
+		{ 1.f, 2, 2 },
+		{ .85f, 2, 1 },
+		{ .7f, 1, 1 },
+		{ .55f, 1, 1 },
+		{ .4f, 1, 1 }
+	};
+	constexpr uint32_t QUALITY_LEVEL_COUNT{ uint32_t( std::size( QUALITY_LEVELS ) ) };
+
+	// Exponential moving average, smooths single slow frames (scene swaps, screenshots) out
+	constexpr float FRAME_TIME_SMOOTHING{ .2f };
+	// Step down when over budget, step up only with clear headroom so levels don't oscillate
+	constexpr float DOWNGRADE_RATIO{ 1.1f };
+	constexpr float UPGRADE_RATIO{ .6f };
+	// Frames to wait after a change, so the average reflects the new level
+	constexpr uint32_t SETTLE_FRAMES{ 8 };
+}
+
+FrameGovernor::FrameGovernor( Renderer* pRenderer, float targetFrameTime ) :
+	m_pRenderer{ pRenderer },
+	m_TargetFrameTime{ targetFrameTime },
+	m_FullShadowSamples{ pRenderer->GetShadowSamples( ) },
+	m_FullIndirectSamples{ pRenderer->GetIndirectSamples( ) }
+{
+}
+
+void FrameGovernor::Update( float elapsedTime )
+{
+	if ( !m_IsEnabled || m_pRenderer->IsAccumulating( ) || elapsedTime <= 0.f )
+	{
+		return;
+	}
+
+	m_SmoothedFrameTime = m_SmoothedFrameTime > 0.f
+		? m_SmoothedFrameTime + ( elapsedTime - m_SmoothedFrameTime ) * FRAME_TIME_SMOOTHING
+		: elapsedTime;
+
+	if ( ++m_FramesSinceChange < SETTLE_FRAMES )
+	{
+		return;
+	}
+
+	if ( m_SmoothedFrameTime > m_TargetFrameTime * DOWNGRADE_RATIO && m_QualityLevel + 1 < QUALITY_LEVEL_COUNT )
+	{
+		++m_QualityLevel;
+		ApplyQualityLevel( );
+	}
+	else if ( m_SmoothedFrameTime < m_TargetFrameTime * UPGRADE_RATIO && m_QualityLevel > 0 )
+	{
+		--m_QualityLevel;
+		ApplyQualityLevel( );
+	}
+	else
+	{
+		return;
+	}
+
+	// Let the new level show in the average before judging it
+	m_FramesSinceChange = 0;
+	m_SmoothedFrameTime = 0.f;
+}
+
+void FrameGovernor::SetEnabled( bool enabled )
+{
+	m_IsEnabled = enabled;
+
+	// Start from full quality either way, disabling restores the original settings
+	m_QualityLevel = 0;
+	m_FramesSinceChange = 0;
+	m_SmoothedFrameTime = 0.f;
+	ApplyQualityLevel( );
+}
+
+void FrameGovernor::ApplyQualityLevel( ) const
+{
+	const QualityLevel& level{ QUALITY_LEVELS[m_QualityLevel] };
+	m_pRenderer->SetRenderScale( level.renderScale );
+	m_pRenderer->SetShadowSamples( std::min( level.shadowSamples, m_FullShadowSamples ) );
+	m_pRenderer->SetIndirectSamples( std::min( level.indirectSamples, m_FullIndirectSamples ) );
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+//Standard includes
+#include <cstdint>
+
+namespace dae
+{
+	class Renderer;
+
+	/**
+	 * \brief Keeps interactive frame times near a target budget. It watches the smoothed frame time and
+	 * steps the renderer along a quality ladder: sample counts first, then internal resolution.
+	 * It steps down when frames run over budget and back up when they finish well within it.
+	 * It holds while the renderer accumulates, because a static view has no frame rate to keep.
+	 */
+	class FrameGovernor final
+	{
+	public:
+		FrameGovernor( Renderer* pRenderer, float targetFrameTime );
+		~FrameGovernor( ) = default;
+
+		FrameGovernor( const FrameGovernor& ) = delete;
+		FrameGovernor( FrameGovernor&& ) noexcept = delete;
+		FrameGovernor& operator=( const FrameGovernor& ) = delete;
+		FrameGovernor& operator=( FrameGovernor&& ) noexcept = delete;
+
+		// Feed the elapsed time of the last frame (Timer::GetElapsed), call between two frames
+		void Update( float elapsedTime );
+
+		void SetEnabled( bool enabled );
+		void ToggleEnabled( ) { SetEnabled( !m_IsEnabled ); }
+		bool IsEnabled( ) const { return m_IsEnabled; }
+
+	private:
+		Renderer* m_pRenderer;
+		float m_TargetFrameTime;
+		int m_FullShadowSamples;
+		int m_FullIndirectSamples;
+		bool m_IsEnabled{ false };
+
+		float m_SmoothedFrameTime{};
+		uint32_t m_QualityLevel{};
+		uint32_t m_FramesSinceChange{};
+
+		void ApplyQualityLevel( ) const;
+	};
+}
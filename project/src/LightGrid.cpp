@@ -0,0 +1,127 @@
+#include "LightGrid.h"
+
+//Standard includes
+#include <algorithm>
+#include <cmath>
+
+// Most cells along one axis, bounds the memory when a few lights reach across the whole scene
+#define LIGHT_GRID_MAX_RESOLUTION 16
+
+using namespace dae;
+
+void LightGrid::Build( const std::vector<Light>& lights )
+{
+	PROFILE_SCOPE( "LightGrid::Build" );
+
+	m_CellStarts.clear( );
+	m_LightIndices.clear( );
+	m_Resolution[0] = m_Resolution[1] = m_Resolution[2] = 0;
+
+	std::vector<uint32_t> pointLights{};
+	float averageRange{};
+	for ( uint32_t lightIdx{}; lightIdx < lights.size( ); ++lightIdx )
+	{
+		const Light& light{ lights[lightIdx] };
+		if ( light.type != LightType::Point || light.range <= 0.f )
+		{
+			continue;
+		}
+
+		const Vector3 reach{ light.range, light.range, light.range };
+		if ( pointLights.empty( ) )
+		{
+			m_BoundsMin = light.origin - reach;
+		}
+		m_BoundsMin = Vector3::Min( m_BoundsMin, light.origin - reach );
+		pointLights.push_back( lightIdx );
+		averageRange += light.range;
+	}
+	if ( pointLights.empty( ) )
+	{
+		return;
+	}
+	averageRange /= float( pointLights.size( ) );
+
+	Vector3 boundsMax{ m_BoundsMin };
+	for ( const uint32_t lightIdx : pointLights )
+	{
+		const Light& light{ lights[lightIdx] };
+		boundsMax = Vector3::Max( boundsMax, light.origin + Vector3{ light.range, light.range, light.range } );
+	}
+
+	// Cells about as big as an average light's range, a light then overlaps a handful of them
+	const Vector3 extent{ boundsMax - m_BoundsMin };
+	for ( int axis{}; axis < 3; ++axis )
+	{
+		m_Resolution[axis] = std::clamp( int( std::ceil( extent[axis] / averageRange ) ), 1, LIGHT_GRID_MAX_RESOLUTION );
+		m_CellSize[axis] = extent[axis] / float( m_Resolution[axis] );
+	}
+
+	// Calls cellFn with every cell the influence sphere of the light overlaps
+	const auto forEachCell = [&]( const Light& light, const auto& cellFn )
+		{
+			int first[3], last[3];
+			for ( int axis{}; axis < 3; ++axis )
+			{
+				first[axis] = std::clamp( int( ( light.origin[axis] - light.range - m_BoundsMin[axis] ) / m_CellSize[axis] ), 0, m_Resolution[axis] - 1 );
+				last[axis] = std::clamp( int( ( light.origin[axis] + light.range - m_BoundsMin[axis] ) / m_CellSize[axis] ), 0, m_Resolution[axis] - 1 );
+			}
+			for ( int z{ first[2] }; z <= last[2]; ++z )
+			{
+				for ( int y{ first[1] }; y <= last[1]; ++y )
+				{
+					for ( int x{ first[0] }; x <= last[0]; ++x )
+					{
+						// Distance from the light to the closest point of the cell
+						const Vector3 cellMin{ m_BoundsMin + Vector3{ x * m_CellSize.x, y * m_CellSize.y, z * m_CellSize.z } };
+						const Vector3 closest{ Vector3::Max( cellMin, Vector3::Min( light.origin, cellMin + m_CellSize ) ) };
+						if ( ( closest - light.origin ).SqrMagnitude( ) <= light.range * light.range )
+						{
+							cellFn( GetCellIndex( x, y, z ) );
+						}
+					}
+				}
+			}
+		};
+
+	// Count first, then fill, so every list sits in one array
+	const int cellCount{ m_Resolution[0] * m_Resolution[1] * m_Resolution[2] };
+	m_CellStarts.assign( cellCount + 1, 0 );
+	for ( const uint32_t lightIdx : pointLights )
+	{
+		forEachCell( lights[lightIdx], [this]( int cellIdx ) { ++m_CellStarts[cellIdx + 1]; } );
+	}
+	for ( int cellIdx{}; cellIdx < cellCount; ++cellIdx )
+	{
+		m_CellStarts[cellIdx + 1] += m_CellStarts[cellIdx];
+	}
+
+	m_LightIndices.resize( m_CellStarts[cellCount] );
+	std::vector<uint32_t> fillCounts( cellCount );
+	for ( const uint32_t lightIdx : pointLights )
+	{
+		forEachCell( lights[lightIdx], [&, lightIdx]( int cellIdx ) { m_LightIndices[m_CellStarts[cellIdx] + fillCounts[cellIdx]++] = lightIdx; } );
+	}
+}
+
+std::span<const uint32_t> LightGrid::GetLights( const Vector3& position ) const
+{
+	if ( m_CellStarts.empty( ) )
+	{
+		return {};
+	}
+
+	int cell[3];
+	for ( int axis{}; axis < 3; ++axis )
+	{
+		cell[axis] = int( std::floor( ( position[axis] - m_BoundsMin[axis] ) / m_CellSize[axis] ) );
+		// Outside of the grid no point light is in range
+		if ( cell[axis] < 0 || cell[axis] >= m_Resolution[axis] )
+		{
+			return {};
+		}
+	}
+
+	const int cellIdx{ GetCellIndex( cell[0], cell[1], cell[2] ) };
+	return { m_LightIndices.data( ) + m_CellStarts[cellIdx], m_CellStarts[cellIdx + 1] - m_CellStarts[cellIdx] };
+}
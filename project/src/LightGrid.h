@@ -0,0 +1,45 @@
+#pragma once
+
+//Standard includes
+#include <cstdint>
+#include <span>
+#include <vector>
+
+//Project includes
+#include "DataTypes.h"
+
+namespace dae
+{
+	/**
+	 * \brief Uniform grid over the influence spheres of the point lights. Every cell lists the lights whose range
+	 * overlaps it, so a shading point only looks at the lights that can still light it, and a light too far away
+	 * to show costs neither shading nor a shadow ray. The lists are a conservative superset, a light near the
+	 * corner of a cell can still be out of range of the point. Directional lights reach everywhere and are left out.
+	 */
+	class LightGrid final
+	{
+	public:
+		LightGrid( ) = default;
+		~LightGrid( ) = default;
+
+		LightGrid( const LightGrid& ) = delete;
+		LightGrid( LightGrid&& ) noexcept = delete;
+		LightGrid& operator=( const LightGrid& ) = delete;
+		LightGrid& operator=( LightGrid&& ) noexcept = delete;
+
+		void Build( const std::vector<Light>& lights );
+
+		// Indices of the point lights that can reach the cell of position, empty outside of every light's range
+		std::span<const uint32_t> GetLights( const Vector3& position ) const;
+
+	private:
+		Vector3 m_BoundsMin{};
+		Vector3 m_CellSize{};
+		int m_Resolution[3]{};
+		// The lists of all cells back to back, cell i owns [m_CellStarts[i], m_CellStarts[i + 1])
+		std::vector<uint32_t> m_CellStarts{};
+		std::vector<uint32_t> m_LightIndices{};
+
+		int GetCellIndex( int x, int y, int z ) const { return ( z * m_Resolution[1] + y ) * m_Resolution[0] + x; }
+	};
+}
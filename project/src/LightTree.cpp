@@ -0,0 +1,157 @@
+#include "LightTree.h"
+
+//Standard includes
+#include <algorithm>
+#include <cmath>
+
+using namespace dae;
+
+void LightTree::Build( const std::vector<Light>& lights )
+{
+	PROFILE_SCOPE( "LightTree::Build" );
+
+	std::vector<uint32_t> lightIndices{};
+	for ( uint32_t lightIdx{}; lightIdx < lights.size( ); ++lightIdx )
+	{
+		if ( lights[lightIdx].type == LightType::Point )
+		{
+			lightIndices.push_back( lightIdx );
+		}
+	}
+
+	m_LightCount = uint32_t( lightIndices.size( ) );
+	m_Nodes.clear( );
+	if ( m_LightCount == 0 )
+	{
+		return;
+	}
+
+	// A binary tree with one light per leaf, reserved up front so nodes don't move while it is built
+	m_Nodes.reserve( 2 * m_LightCount - 1 );
+	m_Nodes.emplace_back( );
+	Subdivide( 0, lightIndices, 0, m_LightCount, lights );
+}
+
+void LightTree::Subdivide( uint32_t nodeIdx, std::vector<uint32_t>& lightIndices, uint32_t first, uint32_t count, const std::vector<Light>& lights )
+{
+	Node& node{ m_Nodes[nodeIdx] };
+	node.boundsMin = lights[lightIndices[first]].origin;
+	node.boundsMax = node.boundsMin;
+	for ( uint32_t idx{ first }; idx < first + count; ++idx )
+	{
+		const Light& light{ lights[lightIndices[idx]] };
+		node.boundsMin = Vector3::Min( node.boundsMin, light.origin );
+		node.boundsMax = Vector3::Max( node.boundsMax, light.origin );
+		node.power += light.intensity * std::max( light.color.r, std::max( light.color.g, light.color.b ) );
+		node.range = std::max( node.range, light.range );
+	}
+
+	if ( count == 1 )
+	{
+		node.isLeaf = true;
+		node.lightOrChildIdx = lightIndices[first];
+		return;
+	}
+
+	// Halve the lights along the longest side, which keeps the tree balanced and its depth logarithmic
+	const Vector3 extent{ node.boundsMax - node.boundsMin };
+	int axis{ 0 };
+	if ( extent.y > extent[axis] )
+	{
+		axis = 1;
+	}
+	if ( extent.z > extent[axis] )
+	{
+		axis = 2;
+	}
+	const uint32_t leftCount{ count / 2 };
+	std::nth_element( lightIndices.begin( ) + first, lightIndices.begin( ) + first + leftCount, lightIndices.begin( ) + first + count,
+		[&lights, axis]( uint32_t lhs, uint32_t rhs ) { return lights[lhs].origin[axis] < lights[rhs].origin[axis]; } );
+
+	const uint32_t childIdx{ uint32_t( m_Nodes.size( ) ) };
+	node.lightOrChildIdx = childIdx;
+	m_Nodes.emplace_back( );
+	m_Nodes.emplace_back( );
+	Subdivide( childIdx, lightIndices, first, leftCount, lights );
+	Subdivide( childIdx + 1, lightIndices, first + leftCount, count - leftCount, lights );
+}
+
+bool LightTree::Sample( const Vector3& position, const Vector3& normal, float u, uint32_t& lightIdx, float& probability ) const
+{
+	if ( m_Nodes.empty( ) || GetImportance( m_Nodes[0], position, normal ) <= 0.f )
+	{
+		return false;
+	}
+
+	probability = 1.f;
+	uint32_t nodeIdx{ 0 };
+	while ( !m_Nodes[nodeIdx].isLeaf )
+	{
+		const uint32_t childIdx{ m_Nodes[nodeIdx].lightOrChildIdx };
+		const float leftImportance{ GetImportance( m_Nodes[childIdx], position, normal ) };
+		const float rightImportance{ GetImportance( m_Nodes[childIdx + 1], position, normal ) };
+		// The bounds of the children are tighter, they can rule out what their parent could not
+		if ( leftImportance + rightImportance <= 0.f )
+		{
+			return false;
+		}
+		const float leftProbability{ leftImportance / ( leftImportance + rightImportance ) };
+
+		// The same random number picks every level, rescaled to what is left of its range
+		if ( u < leftProbability )
+		{
+			u /= leftProbability;
+			probability *= leftProbability;
+			nodeIdx = childIdx;
+		}
+		else
+		{
+			u = ( u - leftProbability ) / ( 1.f - leftProbability );
+			probability *= 1.f - leftProbability;
+			nodeIdx = childIdx + 1;
+		}
+		u = std::min( u, .99999994f );
+	}
+
+	lightIdx = m_Nodes[nodeIdx].lightOrChildIdx;
+	return true;
+}
+
+float LightTree::GetImportance( const Node& node, const Vector3& position, const Vector3& normal ) const
+{
+	// No light below can reach the point when even the closest point of the bounds is out of range
+	const Vector3 closest{ Vector3::Max( node.boundsMin, Vector3::Min( position, node.boundsMax ) ) };
+	if ( ( closest - position ).SqrMagnitude( ) > node.range * node.range )
+	{
+		return 0.f;
+	}
+
+	const Vector3 center{ ( node.boundsMin + node.boundsMax ) * .5f };
+	const Vector3 toCenter{ center - position };
+	const float sqrDistance{ toCenter.SqrMagnitude( ) };
+	const float sqrRadius{ ( node.boundsMax - node.boundsMin ).SqrMagnitude( ) * .25f };
+
+	// Inside the bounding sphere any direction is possible, and the distance can't be told apart from its size
+	if ( sqrDistance <= sqrRadius )
+	{
+		return node.power / std::max( sqrRadius, 1e-6f );
+	}
+
+	// Best cosine any point of the bounding sphere makes with the normal: the angle to its center,
+	// minus the half angle it covers
+	const float distance{ sqrtf( sqrDistance ) };
+	const float cosTheta{ Vector3::Dot( normal, toCenter ) / distance };
+	const float sinBounds{ sqrtf( sqrRadius ) / distance };
+	const float cosBounds{ sqrtf( 1.f - sinBounds * sinBounds ) };
+	float cosBound{ 1.f };
+	if ( cosTheta < cosBounds )
+	{
+		const float sinTheta{ sqrtf( std::max( 0.f, 1.f - cosTheta * cosTheta ) ) };
+		cosBound = cosTheta * cosBounds + sinTheta * sinBounds;
+		if ( cosBound <= 0.f )
+		{
+			return 0.f;
+		}
+	}
+	return node.power * cosBound / sqrDistance;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+//Standard includes
+#include <cstdint>
+#include <vector>
+
+//Project includes
+#include "DataTypes.h"
+
+namespace dae
+{
+	/**
+	 * \brief Bounding volume hierarchy over the point lights of a scene, every node knows the bounds and the total
+	 * power of the lights below it. A shading point picks a light by walking down from the root, choosing each
+	 * child in proportion to an upper bound on what it can contribute there: its power, over the squared distance,
+	 * times the best cosine any of its lights can make with the surface normal. Nodes whose lights are all out of
+	 * range of the point are never picked. Picking a light costs one walk
+	 * down the tree, however many lights the scene has. Directional lights reach everywhere and are left out.
+	 */
+	class LightTree final
+	{
+	public:
+		LightTree( ) = default;
+		~LightTree( ) = default;
+
+		LightTree( const LightTree& ) = delete;
+		LightTree( LightTree&& ) noexcept = delete;
+		LightTree& operator=( const LightTree& ) = delete;
+		LightTree& operator=( LightTree&& ) noexcept = delete;
+
+		void Build( const std::vector<Light>& lights );
+
+		// Picks a point light for the shading point with u in [0, 1). lightIdx indexes the lights the tree was
+		// built from, probability receives the chance it had to be picked. False when no light can reach the point.
+		bool Sample( const Vector3& position, const Vector3& normal, float u, uint32_t& lightIdx, float& probability ) const;
+
+		uint32_t GetLightCount( ) const { return m_LightCount; }
+
+	private:
+		struct Node
+		{
+			Vector3 boundsMin{};
+			Vector3 boundsMax{};
+			float power{};
+			// Largest range of the lights below, farther from the bounds none of them shows
+			float range{};
+			// Leaves hold a light index, inner nodes the index of their first child, the second one follows it
+			uint32_t lightOrChildIdx{};
+			bool isLeaf{};
+		};
+
+		std::vector<Node> m_Nodes{};
+		uint32_t m_LightCount{};
+
+		void Subdivide( uint32_t nodeIdx, std::vector<uint32_t>& lightIndices, uint32_t first, uint32_t count, const std::vector<Light>& lights );
+		float GetImportance( const Node& node, const Vector3& position, const Vector3& normal ) const;
+	};
+}
@@ -2,6 +2,7 @@
 #include "Maths.h"
 #include "DataTypes.h"
 #include "BRDFs.h"
+#include "Utils.h"
 
 #define USE_REFLECTIONS
 
@@ -27,6 +28,38 @@ namespace dae
 		 * \return color
 		 */
 		virtual ColorRGB Shade( ShadeInfo& shadeInfo, const HitRecord& hitRecord = {}, const Vector3& l = {}, const Vector3& v = {} ) = 0;
+
+		/**
+		 * \brief Whether Shade can request a reflection bounce, the color then depends on what the surface reflects
+		 */
+		virtual bool IsReflective( ) const { return false; }
+
+		/**
+		 * \brief Base color of the surface, without lighting. Guides the denoiser along texture and material edges.
+		 */
+		virtual ColorRGB GetAlbedo( ) const = 0;
+
+		/**
+		 * \brief Picks the direction the path tracer continues in, cosine weighted around the normal by default
+		 * \param v view direction
+		 * \param uLobe chooses between the lobes of the BRDF, in [0, 1)
+		 * \param u, w sample point in [0, 1) for the direction within the lobe
+		 * \param l receives the incoming light direction
+		 * \return false when the direction points below the surface
+		 */
+		virtual bool SampleDirection( const HitRecord& hitRecord, [[maybe_unused]] const Vector3& v, [[maybe_unused]] float uLobe, float u, float w, Vector3& l ) const
+		{
+			l = LightUtils::GetCosineWeightedDirection( hitRecord.normal, u, w );
+			return Vector3::Dot( l, hitRecord.normal ) > 0.f;
+		}
+
+		/**
+		 * \brief Density per solid angle of SampleDirection picking l, over all of its lobes
+		 */
+		virtual float GetDirectionPdf( const HitRecord& hitRecord, const Vector3& l, [[maybe_unused]] const Vector3& v ) const
+		{
+			return std::max( Vector3::Dot( l, hitRecord.normal ), 0.f ) / PI;
+		}
 	};
 #pragma endregion
 
@@ -45,6 +78,11 @@ namespace dae
 			return m_Color;
 		}
 
+		ColorRGB GetAlbedo( ) const override
+		{
+			return m_Color;
+		}
+
 	private:
 		ColorRGB m_Color{ colors::White };
 	};
@@ -66,6 +104,11 @@ namespace dae
 			return BRDF::Lambert( m_DiffuseReflectance, m_DiffuseColor );
 		}
 
+		ColorRGB GetAlbedo( ) const override
+		{
+			return m_DiffuseColor * m_DiffuseReflectance;
+		}
+
 	private:
 		ColorRGB m_DiffuseColor{ colors::White };
 		float m_DiffuseReflectance{ 1.f }; //kd
@@ -91,6 +134,11 @@ namespace dae
 				+ BRDF::Phong( m_SpecularReflectance, m_PhongExponent, l, v, hitRecord.normal );
 		}
 
+		ColorRGB GetAlbedo( ) const override
+		{
+			return m_DiffuseColor * m_DiffuseReflectance;
+		}
+
 	private:
 		ColorRGB m_DiffuseColor{ colors::White };
 		float m_DiffuseReflectance{ 0.5f }; //kd
@@ -127,17 +175,84 @@ namespace dae
 			{
 				shadeInfo.needsBounce = true;
 				shadeInfo.reflectionRay = { hitRecord.origin + hitRecord.normal * .0001f, Vector3::Reflect( -v, hitRecord.normal ) };
-				shadeInfo.reflectance = powf(1.f - m_Roughness, 2);
+				shadeInfo.reflectance = Square(1.f - m_Roughness);
 			}
 #endif
 
 			return specular + diffuse;
 		}
 
+		ColorRGB GetAlbedo( ) const override
+		{
+			return m_Albedo;
+		}
+
+		bool IsReflective( ) const override
+		{
+#ifdef USE_REFLECTIONS
+			return m_Metalness == 1.f;
+#else
+			return false;
+#endif
+		}
+
+		bool SampleDirection( const HitRecord& hitRecord, const Vector3& v, float uLobe, float u, float w, Vector3& l ) const override
+		{
+			if ( uLobe < GetSpecularProbability( hitRecord, v ) )
+			{
+				// GGX importance sampling: pick a microfacet normal by its distribution, and mirror v around it
+				const float a{ Pow<4>( m_Roughness ) };
+				const float cosTheta{ sqrtf( ( 1.f - u ) / ( 1.f + ( a - 1.f ) * u ) ) };
+				const float sinTheta{ sqrtf( std::max( 0.f, 1.f - cosTheta * cosTheta ) ) };
+				float sinPhi, cosPhi;
+				FastMath::SinCos( 2.f * PI * w, sinPhi, cosPhi );
+				Vector3 tangent, bitangent;
+				LightUtils::GetOrthonormalBasis( hitRecord.normal, tangent, bitangent );
+				const Vector3 h{ tangent * ( sinTheta * cosPhi ) + bitangent * ( sinTheta * sinPhi ) + hitRecord.normal * cosTheta };
+				l = Vector3::Reflect( -v, h );
+			}
+			else
+			{
+				l = LightUtils::GetCosineWeightedDirection( hitRecord.normal, u, w );
+			}
+			return Vector3::Dot( l, hitRecord.normal ) > 0.f;
+		}
+
+		float GetDirectionPdf( const HitRecord& hitRecord, const Vector3& l, const Vector3& v ) const override
+		{
+			const float cosine{ Vector3::Dot( l, hitRecord.normal ) };
+			if ( cosine <= 0.f )
+			{
+				return 0.f;
+			}
+
+			// Either lobe can pick any direction, weighing both pdfs together is the balance heuristic
+			// of one-sample MIS: a direction one lobe rarely picks is not divided by its small pdf alone
+			const Vector3 h{ ( l + v ).Normalized( ) };
+			const float viewDotH{ Vector3::Dot( v, h ) };
+			const float specularPdf{ viewDotH > 0.f ? BRDF::NormalDistribution_GGX( hitRecord.normal, h, m_Roughness ) * Vector3::Dot( hitRecord.normal, h ) / ( 4.f * viewDotH ) : 0.f };
+			const float specularProbability{ GetSpecularProbability( hitRecord, v ) };
+			return specularProbability * specularPdf + ( 1.f - specularProbability ) * cosine / PI;
+		}
+
 	private:
 		ColorRGB m_Albedo{ 0.955f, 0.637f, 0.538f }; //Copper
 		float m_Metalness{ 1.0f };
 		float m_Roughness{ 0.1f }; // [1.0 > 0.0] >> [ROUGH > SMOOTH]
+
+		// Chance to sample the specular lobe: metals only have that one, dielectrics weigh the Fresnel
+		// reflectance toward v against what is left for the diffuse albedo
+		float GetSpecularProbability( const HitRecord& hitRecord, const Vector3& v ) const
+		{
+			if ( m_Metalness == 1.f )
+			{
+				return 1.f;
+			}
+			const ColorRGB fresnel{ BRDF::FresnelFunction_Schlick( hitRecord.normal, v, ( m_Metalness == 0.f ? ColorRGB{ .04f, .04f, .04f } : m_Albedo ) ) };
+			const float specular{ std::max( fresnel.r, std::max( fresnel.g, fresnel.b ) ) };
+			const float diffuse{ std::max( m_Albedo.r, std::max( m_Albedo.g, m_Albedo.b ) ) * ( 1.f - specular ) };
+			return specular / ( specular + diffuse );
+		}
 	};
 #pragma endregion
 }
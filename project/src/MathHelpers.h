@@ -20,6 +20,25 @@ namespace dae
 		return a * a;
 	}
 
+	// Whole powers by repeated squaring, x^5 takes three multiplications instead of a call to powf
+	template<unsigned int N>
+	constexpr float Pow(float a)
+	{
+		if constexpr (N == 0)
+		{
+			return 1.f;
+		}
+		else if constexpr (N % 2 == 0)
+		{
+			const float half{ Pow<N / 2>(a) };
+			return half * half;
+		}
+		else
+		{
+			return a * Pow<N - 1>(a);
+		}
+	}
+
 	inline float Lerpf(float a, float b, float factor)
 	{
 		return ((1 - factor) * a) + (factor * b);
@@ -27,6 +46,6 @@ namespace dae
 
 	inline bool AreEqual(float a, float b, float epsilon = FLT_EPSILON)
 	{
-		return abs(a - b) < epsilon;
+		return std::abs(a - b) < epsilon;
 	}
 }
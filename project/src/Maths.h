@@ -4,4 +4,5 @@
 #include "Matrix.h"
 #include "ColorRGB.h"
 #include "MathHelpers.h"
+#include "FastMath.h"
 
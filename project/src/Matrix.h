@@ -1,4 +1,7 @@
 #pragma once
+#include <cassert>
+#include <cmath>
+
 #include "Vector3.h"
 #include "Vector4.h"
 
@@ -6,47 +9,217 @@ namespace dae {
 	struct Matrix
 	{
 		Matrix() = default;
-		Matrix(
+		constexpr Matrix(
 			const Vector3& xAxis,
 			const Vector3& yAxis,
 			const Vector3& zAxis,
-			const Vector3& t);
+			const Vector3& t) :
+			Matrix( { xAxis, 0 }, { yAxis, 0 }, { zAxis, 0 }, { t, 1 } )
+		{
+		}
 
-		Matrix(
+		constexpr Matrix(
 			const Vector4& xAxis,
 			const Vector4& yAxis,
 			const Vector4& zAxis,
-			const Vector4& t);
-
-		Matrix(const Matrix& m);
-
-		Vector3 TransformVector(const Vector3& v) const;
-		Vector3 TransformVector(float x, float y, float z) const;
-		Vector3 TransformPoint(const Vector3& p) const;
-		Vector3 TransformPoint(float x, float y, float z) const;
-		const Matrix& Transpose();
-
-		Vector3 GetAxisX() const;
-		Vector3 GetAxisY() const;
-		Vector3 GetAxisZ() const;
-		Vector3 GetTranslation() const;
-
-		static Matrix CreateTranslation(float x, float y, float z);
-		static Matrix CreateTranslation(const Vector3& t);
-		static Matrix CreateRotationX(float pitch);
-		static Matrix CreateRotationY(float yaw);
-		static Matrix CreateRotationZ(float roll);
-		static Matrix CreateRotation(float pitch, float yaw, float roll);
-		static Matrix CreateRotation(const Vector3& r);
-		static Matrix CreateScale(float sx, float sy, float sz);
-		static Matrix CreateScale(const Vector3& s);
-		static Matrix Transpose(const Matrix& m);
-
-		Vector4& operator[](int index);
-		Vector4 operator[](int index) const;
-		Matrix operator*(const Matrix& m) const;
-		const Matrix& operator*=(const Matrix& m);
-		bool operator==(const Matrix& m) const;
+			const Vector4& t) :
+			data{ xAxis, yAxis, zAxis, t }
+		{
+		}
+
+		constexpr Vector3 TransformVector(const Vector3& v) const
+		{
+			return TransformVector( v.x, v.y, v.z );
+		}
+
+		constexpr Vector3 TransformVector(float x, float y, float z) const
+		{
+			return Vector3{
+				data[0].x * x + data[1].x * y + data[2].x * z,
+				data[0].y * x + data[1].y * y + data[2].y * z,
+				data[0].z * x + data[1].z * y + data[2].z * z
+			};
+		}
+
+		constexpr Vector3 TransformPoint(const Vector3& p) const
+		{
+			return TransformPoint( p.x, p.y, p.z );
+		}
+
+		constexpr Vector3 TransformPoint(float x, float y, float z) const
+		{
+			return Vector3{
+				data[0].x * x + data[1].x * y + data[2].x * z + data[3].x,
+				data[0].y * x + data[1].y * y + data[2].y * z + data[3].y,
+				data[0].z * x + data[1].z * y + data[2].z * z + data[3].z,
+			};
+		}
+
+		const Matrix& Transpose()
+		{
+			Matrix result{};
+			for ( int r{ 0 }; r < 4; ++r )
+			{
+				for ( int c{ 0 }; c < 4; ++c )
+				{
+					result[r][c] = data[c][r];
+				}
+			}
+
+			data[0] = result[0];
+			data[1] = result[1];
+			data[2] = result[2];
+			data[3] = result[3];
+
+			return *this;
+		}
+
+		Vector3 GetAxisX() const
+		{
+			return data[0];
+		}
+
+		Vector3 GetAxisY() const
+		{
+			return data[1];
+		}
+
+		Vector3 GetAxisZ() const
+		{
+			return data[2];
+		}
+
+		Vector3 GetTranslation() const
+		{
+			return data[3];
+		}
+
+		static Matrix CreateTranslation(float x, float y, float z)
+		{
+			return CreateTranslation( { x, y, z } );
+		}
+
+		static Matrix CreateTranslation(const Vector3& t)
+		{
+			return Matrix{
+				{ Vector3::UnitX, 0.f },
+				{ Vector3::UnitY, 0.f },
+				{ Vector3::UnitZ, 0.f },
+				{ t, 1.f} };
+		}
+
+		static Matrix CreateRotationX(float pitch)
+		{
+			return {
+				Vector3::UnitX,
+				{ 0.f, cosf( pitch ), sinf( pitch ) },
+				{ 0.f, -sinf( pitch ), cosf( pitch ) },
+				{} };
+		}
+
+		static Matrix CreateRotationY(float yaw)
+		{
+			return {
+				{ cosf( yaw ), 0.f, -sinf( yaw ) },
+				Vector3::UnitY,
+				{ sinf( yaw ), 0.f, cosf( yaw ) },
+				{} };
+		}
+
+		static Matrix CreateRotationZ(float roll)
+		{
+			return {
+				{ cosf( roll ), sinf( roll ), 0.f },
+				{ -sinf( roll ), cosf( roll ), 0.f },
+				Vector3::UnitZ,
+				{} };
+		}
+
+		static Matrix CreateRotation(float pitch, float yaw, float roll)
+		{
+			return CreateRotation( { pitch, yaw, roll } );
+		}
+
+		static Matrix CreateRotation(const Vector3& r)
+		{
+			return CreateRotationX( r.x ) * CreateRotationY( r.y ) * CreateRotationZ( r.z );
+		}
+
+		static Matrix CreateScale(float sx, float sy, float sz)
+		{
+			return {
+				{ sx, 0.f, 0.f, 0.f },
+				{ 0.f, sy, 0.f, 0.f },
+				{ 0.f, 0.f, sz, 0.f },
+				{ 0.f, 0.f, 0.f, 1.f} };
+		}
+
+		static Matrix CreateScale(const Vector3& s)
+		{
+			return CreateScale( s[0], s[1], s[2] );
+		}
+
+		static Matrix Transpose(const Matrix& m)
+		{
+			Matrix out{ m };
+			out.Transpose( );
+
+			return out;
+		}
+
+#pragma region Operator Overloads
+		constexpr Vector4& operator[](int index)
+		{
+			assert( index <= 3 && index >= 0 );
+			return data[index];
+		}
+
+		constexpr Vector4 operator[](int index) const
+		{
+			assert( index <= 3 && index >= 0 );
+			return data[index];
+		}
+
+		Matrix operator*(const Matrix& m) const
+		{
+			Matrix result{};
+			Matrix m_transposed = Transpose( m );
+
+			for ( int r{ 0 }; r < 4; ++r )
+			{
+				for ( int c{ 0 }; c < 4; ++c )
+				{
+					result[r][c] = Vector4::Dot( data[r], m_transposed[c] );
+				}
+			}
+
+			return result;
+		}
+
+		const Matrix& operator*=(const Matrix& m)
+		{
+			Matrix copy{ *this };
+			Matrix m_transposed = Transpose( m );
+
+			for ( int r{ 0 }; r < 4; ++r )
+			{
+				for ( int c{ 0 }; c < 4; ++c )
+				{
+					data[r][c] = Vector4::Dot( copy[r], m_transposed[c] );
+				}
+			}
+
+			return *this;
+		}
+
+		bool operator==(const Matrix& m) const
+		{
+			return data[0] == m.data[0]
+				&& data[1] == m.data[1]
+				&& data[2] == m.data[2]
+				&& data[3] == m.data[3];
+		}
+#pragma endregion
 
 	private:
 
@@ -64,4 +237,4 @@ namespace dae {
 		// v2x v2y v2z v2w
 		// v3x v3y v3z v3w
 	};
-}
\ No newline at end of file
+}
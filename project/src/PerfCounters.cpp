@@ -0,0 +1,192 @@
+#include "PerfCounters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+using namespace dae;
+
+PerfCounterValues& PerfCounterValues::operator+=( const PerfCounterValues& other )
+{
+	for ( size_t counterIdx{}; counterIdx < values.size( ); ++counterIdx )
+	{
+		if ( other.values[counterIdx] )
+		{
+			values[counterIdx] = values[counterIdx].value_or( 0 ) + *other.values[counterIdx];
+		}
+	}
+	return *this;
+}
+
+const char* PerfCounters::GetName( PerfCounter counter )
+{
+	switch ( counter )
+	{
+	case PerfCounter::Cycles:
+		return "cycles";
+	case PerfCounter::Instructions:
+		return "instructions";
+	case PerfCounter::L1DataMisses:
+		return "l1dMisses";
+	case PerfCounter::LastLevelCacheMisses:
+		return "llcMisses";
+	case PerfCounter::BranchMisses:
+		return "branchMisses";
+	default:
+		return "unknown";
+	}
+}
+
+#ifdef __linux__
+namespace
+{
+	perf_event_attr CreateAttributes( PerfCounter counter )
+	{
+		perf_event_attr attributes{};
+		attributes.size = sizeof( perf_event_attr );
+		attributes.disabled = 1;
+		attributes.inherit = 1;
+		attributes.exclude_kernel = 1;
+		attributes.exclude_hv = 1;
+		// Lets us scale the value when the kernel multiplexes more counters than the PMU has
+		attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		switch ( counter )
+		{
+		case PerfCounter::Cycles:
+			attributes.type = PERF_TYPE_HARDWARE;
+			attributes.config = PERF_COUNT_HW_CPU_CYCLES;
+			break;
+		case PerfCounter::Instructions:
+			attributes.type = PERF_TYPE_HARDWARE;
+			attributes.config = PERF_COUNT_HW_INSTRUCTIONS;
+			break;
+		case PerfCounter::L1DataMisses:
+			attributes.type = PERF_TYPE_HW_CACHE;
+			attributes.config = PERF_COUNT_HW_CACHE_L1D
+				| ( PERF_COUNT_HW_CACHE_OP_READ << 8 )
+				| ( PERF_COUNT_HW_CACHE_RESULT_MISS << 16 );
+			break;
+		case PerfCounter::LastLevelCacheMisses:
+			attributes.type = PERF_TYPE_HARDWARE;
+			attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+			break;
+		case PerfCounter::BranchMisses:
+			attributes.type = PERF_TYPE_HARDWARE;
+			attributes.config = PERF_COUNT_HW_BRANCH_MISSES;
+			break;
+		default:
+			break;
+		}
+		return attributes;
+	}
+}
+
+PerfCounters::PerfCounters( )
+{
+	for ( size_t counterIdx{}; counterIdx < m_FileDescriptors.size( ); ++counterIdx )
+	{
+		perf_event_attr attributes{ CreateAttributes( PerfCounter( counterIdx ) ) };
+
+		// Calling process, any cpu, no group
+		m_FileDescriptors[counterIdx] = int( syscall( SYS_perf_event_open, &attributes, 0, -1, -1, 0 ) );
+		if ( m_FileDescriptors[counterIdx] < 0 && m_Error.empty( ) )
+		{
+			m_Error = std::string{ GetName( PerfCounter( counterIdx ) ) } + ": " + std::strerror( errno );
+		}
+	}
+
+	if ( IsAvailable( ) )
+	{
+		m_Error.clear( );
+	}
+}
+
+PerfCounters::~PerfCounters( )
+{
+	for ( const int fileDescriptor : m_FileDescriptors )
+	{
+		if ( fileDescriptor >= 0 )
+		{
+			close( fileDescriptor );
+		}
+	}
+}
+
+bool PerfCounters::IsAvailable( ) const
+{
+	for ( const int fileDescriptor : m_FileDescriptors )
+	{
+		if ( fileDescriptor >= 0 )
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void PerfCounters::Start( )
+{
+	for ( const int fileDescriptor : m_FileDescriptors )
+	{
+		if ( fileDescriptor >= 0 )
+		{
+			ioctl( fileDescriptor, PERF_EVENT_IOC_RESET, 0 );
+			ioctl( fileDescriptor, PERF_EVENT_IOC_ENABLE, 0 );
+		}
+	}
+}
+
+PerfCounterValues PerfCounters::Stop( )
+{
+	PerfCounterValues result{};
+	for ( size_t counterIdx{}; counterIdx < m_FileDescriptors.size( ); ++counterIdx )
+	{
+		const int fileDescriptor{ m_FileDescriptors[counterIdx] };
+		if ( fileDescriptor < 0 )
+		{
+			continue;
+		}
+
+		ioctl( fileDescriptor, PERF_EVENT_IOC_DISABLE, 0 );
+
+		// value, time enabled, time running
+		uint64_t data[3]{};
+		if ( read( fileDescriptor, data, sizeof( data ) ) != sizeof( data ) || data[2] == 0 )
+		{
+			continue;
+		}
+
+		const double scale{ double( data[1] ) / double( data[2] ) };
+		result.values[counterIdx] = uint64_t( double( data[0] ) * scale );
+	}
+	return result;
+}
+#else
+PerfCounters::PerfCounters( ) :
+	m_Error{ "hardware counters are only supported on Linux" }
+{
+	m_FileDescriptors.fill( -1 );
+}
+
+PerfCounters::~PerfCounters( ) = default;
+
+bool PerfCounters::IsAvailable( ) const
+{
+	return false;
+}
+
+void PerfCounters::Start( )
+{
+}
+
+PerfCounterValues PerfCounters::Stop( )
+{
+	return {};
+}
+#endif
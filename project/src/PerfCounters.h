@@ -0,0 +1,62 @@
+#pragma once
+
+//Standard includes
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace dae
+{
+	enum class PerfCounter
+	{
+		Cycles,
+		Instructions,
+		L1DataMisses,
+		LastLevelCacheMisses,
+		BranchMisses,
+		Count
+	};
+
+	// Counter totals of one measured phase. Counters the machine cannot provide stay empty.
+	struct PerfCounterValues
+	{
+		std::array<std::optional<uint64_t>, size_t( PerfCounter::Count )> values{};
+
+		std::optional<uint64_t>& operator[]( PerfCounter counter ) { return values[size_t( counter )]; }
+		const std::optional<uint64_t>& operator[]( PerfCounter counter ) const { return values[size_t( counter )]; }
+
+		PerfCounterValues& operator+=( const PerfCounterValues& other );
+	};
+
+	/**
+	 * \brief Hardware performance counters of the calling process, read through Linux perf_event_open.
+	 * Counters are inherited by threads created after construction, so construct this before the render
+	 * workers are spawned. On other platforms, or when the kernel refuses access (perf_event_paranoid,
+	 * virtual machines), IsAvailable returns false and every value stays empty.
+	 */
+	class PerfCounters final
+	{
+	public:
+		PerfCounters( );
+		~PerfCounters( );
+
+		PerfCounters( const PerfCounters& ) = delete;
+		PerfCounters( PerfCounters&& ) noexcept = delete;
+		PerfCounters& operator=( const PerfCounters& ) = delete;
+		PerfCounters& operator=( PerfCounters&& ) noexcept = delete;
+
+		bool IsAvailable( ) const;
+		// Reason the counters could not be opened, empty when at least one counter is available
+		const std::string& GetError( ) const { return m_Error; }
+
+		void Start( );
+		PerfCounterValues Stop( );
+
+		static const char* GetName( PerfCounter counter );
+
+	private:
+		std::array<int, size_t( PerfCounter::Count )> m_FileDescriptors{};
+		std::string m_Error{};
+	};
+}
@@ -0,0 +1,189 @@
+#include "Profiler.h"
+
+//Standard includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace dae;
+
+namespace
+{
+	constexpr uint32_t ZONES_PER_THREAD{ 1 << 14 };
+
+	struct Zone
+	{
+		const char* name;
+		uint64_t startNs;
+		uint64_t endNs;
+	};
+
+	// The fields are atomic so WriteChromeTrace can copy a slot while the owning thread overwrites it,
+	// torn copies are recognized by the zone count and dropped
+	struct ZoneSlot
+	{
+		std::atomic<const char*> name;
+		std::atomic<uint64_t> startNs;
+		std::atomic<uint64_t> endNs;
+	};
+
+	// Written by its owning thread only, read by WriteChromeTrace
+	struct ZoneBuffer final
+	{
+		uint32_t threadId{};
+		std::string threadName{};
+		std::unique_ptr<ZoneSlot[]> pZones{ std::make_unique<ZoneSlot[]>( ZONES_PER_THREAD ) };
+		std::atomic<uint64_t> zoneCount{};
+	};
+
+	// Buffers outlive their thread so zones of finished threads still end up in the trace
+	std::mutex s_BufferMutex{};
+	std::vector<std::shared_ptr<ZoneBuffer>> s_Buffers{};
+
+	uint64_t NowNs( )
+	{
+		using namespace std::chrono;
+		return duration_cast<nanoseconds>( steady_clock::now( ).time_since_epoch( ) ).count( );
+	}
+
+	ZoneBuffer& GetThreadBuffer( )
+	{
+		thread_local const std::shared_ptr<ZoneBuffer> pBuffer{ []( )
+			{
+				auto pNewBuffer{ std::make_shared<ZoneBuffer>( ) };
+
+				std::lock_guard lock{ s_BufferMutex };
+				pNewBuffer->threadId = uint32_t( s_Buffers.size( ) );
+				pNewBuffer->threadName = "Thread " + std::to_string( pNewBuffer->threadId );
+				s_Buffers.push_back( pNewBuffer );
+				return pNewBuffer;
+			}( ) };
+		return *pBuffer;
+	}
+
+	// Copies the zones of a buffer whose thread may still be recording
+	std::vector<Zone> SnapshotZones( const ZoneBuffer& buffer )
+	{
+		const uint64_t zoneCount{ buffer.zoneCount.load( std::memory_order_acquire ) };
+		const uint64_t firstZone{ zoneCount > ZONES_PER_THREAD ? zoneCount - ZONES_PER_THREAD : 0 };
+
+		std::vector<Zone> zones{};
+		zones.reserve( zoneCount - firstZone );
+		for ( uint64_t zoneIdx{ firstZone }; zoneIdx < zoneCount; ++zoneIdx )
+		{
+			const ZoneSlot& slot{ buffer.pZones[zoneIdx % ZONES_PER_THREAD] };
+			zones.push_back( {
+				slot.name.load( std::memory_order_relaxed ),
+				slot.startNs.load( std::memory_order_relaxed ),
+				slot.endNs.load( std::memory_order_relaxed ) } );
+		}
+
+		// Zone n lands in the slot of zone n - ZONES_PER_THREAD before the count passes n, so every zone up to
+		// the one in flight once the copy is done may have overwritten one we copied
+		std::atomic_thread_fence( std::memory_order_acquire );
+		const uint64_t zoneCountAfter{ buffer.zoneCount.load( std::memory_order_relaxed ) };
+		const uint64_t firstIntactZone{ zoneCountAfter + 1 > ZONES_PER_THREAD ? zoneCountAfter + 1 - ZONES_PER_THREAD : 0 };
+		if ( firstIntactZone > firstZone )
+		{
+			zones.erase( zones.begin( ), zones.begin( ) + std::min( firstIntactZone - firstZone, uint64_t( zones.size( ) ) ) );
+		}
+		return zones;
+	}
+
+	void WriteEscaped( std::ofstream& fileStream, const std::string& text )
+	{
+		for ( const char character : text )
+		{
+			if ( character == '"' || character == '\\' )
+			{
+				fileStream << '\\';
+			}
+			fileStream << character;
+		}
+	}
+}
+
+Profiler::ScopedZone::ScopedZone( const char* name ) :
+	m_Name{ name },
+	m_StartNs{ NowNs( ) }
+{
+}
+
+Profiler::ScopedZone::~ScopedZone( )
+{
+	ZoneBuffer& buffer{ GetThreadBuffer( ) };
+
+	const uint64_t zoneIdx{ buffer.zoneCount.load( std::memory_order_relaxed ) };
+	ZoneSlot& slot{ buffer.pZones[zoneIdx % ZONES_PER_THREAD] };
+	slot.name.store( m_Name, std::memory_order_relaxed );
+	slot.startNs.store( m_StartNs, std::memory_order_relaxed );
+	slot.endNs.store( NowNs( ), std::memory_order_relaxed );
+	buffer.zoneCount.store( zoneIdx + 1, std::memory_order_release );
+}
+
+void Profiler::SetThreadName( const std::string& name )
+{
+	ZoneBuffer& buffer{ GetThreadBuffer( ) };
+
+	std::lock_guard lock{ s_BufferMutex };
+	buffer.threadName = name;
+}
+
+bool Profiler::WriteChromeTrace( const std::string& path )
+{
+	std::ofstream fileStream( path );
+	if ( !fileStream )
+	{
+		return false;
+	}
+
+	std::lock_guard lock{ s_BufferMutex };
+
+	// The threads keep recording while the trace is written, work on a copy of every buffer
+	std::vector<std::vector<Zone>> bufferZones{};
+	bufferZones.reserve( s_Buffers.size( ) );
+	for ( const auto& pBuffer : s_Buffers )
+	{
+		bufferZones.push_back( SnapshotZones( *pBuffer ) );
+	}
+
+	// Timestamps are relative to the oldest zone still in the buffers
+	uint64_t originNs{ UINT64_MAX };
+	for ( const std::vector<Zone>& zones : bufferZones )
+	{
+		for ( const Zone& zone : zones )
+		{
+			originNs = std::min( originNs, zone.startNs );
+		}
+	}
+
+	fileStream << std::fixed << std::setprecision( 3 );
+	fileStream << "{\n\"displayTimeUnit\": \"ms\",\n\"traceEvents\": [\n";
+	bool isFirstEvent{ true };
+	for ( size_t bufferIdx{}; bufferIdx < s_Buffers.size( ); ++bufferIdx )
+	{
+		const ZoneBuffer* pBuffer{ s_Buffers[bufferIdx].get( ) };
+		fileStream << ( isFirstEvent ? "" : ",\n" );
+		fileStream << "{ \"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << pBuffer->threadId << ", \"args\": { \"name\": \"";
+		WriteEscaped( fileStream, pBuffer->threadName );
+		fileStream << "\" } }";
+		isFirstEvent = false;
+
+		for ( const Zone& zone : bufferZones[bufferIdx] )
+		{
+			fileStream << ",\n{ \"name\": \"";
+			WriteEscaped( fileStream, zone.name );
+			fileStream << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << pBuffer->threadId
+				<< ", \"ts\": " << double( zone.startNs - originNs ) / 1000.0
+				<< ", \"dur\": " << double( zone.endNs - zone.startNs ) / 1000.0 << " }";
+		}
+	}
+	fileStream << "\n]\n}\n";
+
+	return bool( fileStream );
+}
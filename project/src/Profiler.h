@@ -0,0 +1,50 @@
+#pragma once
+
+//Standard includes
+#include <cstdint>
+#include <string>
+
+// Scoped timing zones. Compiled in when ENABLE_PROFILING is defined (always in Debug, see CMakeLists.txt),
+// otherwise PROFILE_SCOPE expands to nothing and costs nothing.
+// Every thread records into its own ring buffer, so zones never contend; once a buffer is full the oldest zones are overwritten.
+namespace dae::Profiler
+{
+	class ScopedZone final
+	{
+	public:
+		explicit ScopedZone( const char* name );
+		~ScopedZone( );
+
+		ScopedZone( const ScopedZone& ) = delete;
+		ScopedZone( ScopedZone&& ) noexcept = delete;
+		ScopedZone& operator=( const ScopedZone& ) = delete;
+		ScopedZone& operator=( ScopedZone&& ) noexcept = delete;
+
+	private:
+		const char* m_Name;
+		uint64_t m_StartNs;
+	};
+
+	// Label for the calling thread in the trace viewer
+	void SetThreadName( const std::string& name );
+
+	// Writes every recorded zone as Chrome trace JSON (chrome://tracing, ui.perfetto.dev). Returns false on failure.
+	bool WriteChromeTrace( const std::string& path );
+
+	constexpr bool IsEnabled( )
+	{
+#ifdef ENABLE_PROFILING
+		return true;
+#else
+		return false;
+#endif
+	}
+}
+
+#ifdef ENABLE_PROFILING
+#define PROFILE_CONCAT_INNER( a, b ) a##b
+#define PROFILE_CONCAT( a, b ) PROFILE_CONCAT_INNER( a, b )
+#define PROFILE_SCOPE( name ) const dae::Profiler::ScopedZone PROFILE_CONCAT( profileZone, __LINE__ ){ name }
+#else
+#define PROFILE_SCOPE( name )
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+
+//Standard includes
+#include <cstdint>
+
+//Project includes
+#include "mangled_random.hpp"
+
+namespace dae
+{
+	/**
+	 * \brief Stateless random numbers for one sample of one pixel. Every value is a hash of the pixel, the frame,
+	 * the sample index and the dimension it is drawn for, so it does not depend on which thread traces the pixel
+	 * or in which order. The same frame renders bit-identically no matter how the work is split up.
+	 */
+	class RandomStream final
+	{
+	public:
+		RandomStream( uint32_t pixelIdx, uint32_t frameIdx, uint32_t sampleIdx ) :
+			// Hashed level by level, a linear combination of the keys would make neighbouring pixels collide
+			m_Seed{ Get1dNoiseUint( int( pixelIdx ), Get2dNoiseUint( int( frameIdx ), int( sampleIdx ) ) ) }
+		{
+		}
+
+		// Value of the next dimension, in [0, 1]
+		float Next( ) { return Get( m_Dimension++ ); }
+		// Value of any dimension of this sample, in [0, 1], without advancing the stream
+		float Get( uint32_t dimension ) const { return Get1dNoiseZeroToOne( int( dimension ), m_Seed ); }
+		uint32_t GetDimension( ) const { return m_Dimension; }
+
+	private:
+		uint32_t m_Seed;
+		uint32_t m_Dimension{};
+	};
+}
@@ -4,9 +4,15 @@
 #include <execution>
 #include <random>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <numeric>
+#include <bit>
+#include <span>
 
 //Project includes
 #include "Renderer.h"
+#include "Denoiser.h"
 #include "Maths.h"
 #include "Matrix.h"
 #include "Material.h"
@@ -15,158 +21,1032 @@
 #define USE_PARALLEL_EXECUTION
 
 #define MAX_RAY_BOUNCES 1
+// Secondary rays that can change the pixel by less than this are not traced
+#define MIN_RAY_CONTRIBUTION .004f
+// From this bounce on, a path continues with a probability of its throughput
+#define RUSSIAN_ROULETTE_MIN_BOUNCE 1
+#define RUSSIAN_ROULETTE_MIN_PROBABILITY .05f
 
 #define INDIRECT_SAMPLING 3
-#define INDIRECT_LIGHTING_FACTOR .1f
-#define INDIRECT_MAX_DEVIATION 0.3f
+
+// Longest path the path tracer follows, Russian roulette ends most of them long before
+#define PATH_MAX_BOUNCES 8
+
+// Point lights shaded per hit, scenes with more pick this many through the light tree
+#define LIGHT_SAMPLES 4
 
 #define SHADOW_SAMPLES 4
 #define SHADOW_RADIUS .05f
 
+#define TILE_SIZE 16
+
+#define ADAPTIVE_MIN_SAMPLES 4
+#define ADAPTIVE_MAX_SAMPLES 8
+#define ADAPTIVE_ERROR_THRESHOLD .002f
+
+#define UPSCALE_EDGE_SIGMA .1f
+
 using namespace dae;
 
+namespace
+{
+	// Each thread counts into its own slot, so workers never share a cache line while tracing.
+	// Slots of finished threads are folded into s_RetiredRayCounters.
+	struct RayCounterSlot;
+
+	std::mutex s_RayCounterMutex{};
+	std::vector<RayCounterSlot*> s_RayCounterSlots{};
+	RayCounters s_RetiredRayCounters{};
+
+	struct RayCounterSlot final
+	{
+		std::atomic<uint64_t> primary{};
+		std::atomic<uint64_t> shadow{};
+		std::atomic<uint64_t> secondary{};
+
+		RayCounterSlot( )
+		{
+			std::lock_guard lock{ s_RayCounterMutex };
+			s_RayCounterSlots.push_back( this );
+		}
+
+		~RayCounterSlot( )
+		{
+			std::lock_guard lock{ s_RayCounterMutex };
+			s_RetiredRayCounters.primary += primary.load( std::memory_order_relaxed );
+			s_RetiredRayCounters.shadow += shadow.load( std::memory_order_relaxed );
+			s_RetiredRayCounters.secondary += secondary.load( std::memory_order_relaxed );
+			std::erase( s_RayCounterSlots, this );
+		}
+	};
+
+	thread_local RayCounterSlot tl_RayCounters{};
+
+	// Only the owning thread writes, a plain load/store keeps the increment free of lock prefixes
+	inline void CountRay( std::atomic<uint64_t>& counter )
+	{
+		counter.store( counter.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+	}
+
+	inline float GetLuminance( const ColorRGB& color )
+	{
+		return .2126f * color.r + .7152f * color.g + .0722f * color.b;
+	}
+
+	inline float GetMaxComponent( const ColorRGB& color )
+	{
+		return std::max( color.r, std::max( color.g, color.b ) );
+	}
+
+	inline bool IsReflectiveHit( const Scene* pScene, const HitRecord& hitRecord )
+	{
+		return hitRecord.didHit && pScene->GetMaterials( )[hitRecord.materialIndex]->IsReflective( );
+	}
+
+	// Calls lightFn with every light the hit is shaded with and the weight its contribution gets
+	template<typename LightFn>
+	void ForEachLightSample( Scene* pScene, const HitRecord& hitRecord, Sampler& sampler, const LightFn& lightFn )
+	{
+		const std::vector<Light>& lights{ pScene->GetLights( ) };
+		// Directional lights reach every point the same way, they are always shaded
+		for ( const Light& light : lights )
+		{
+			if ( light.type == LightType::Directional )
+			{
+				lightFn( light, 1.f );
+			}
+		}
+
+		// Point lights too far away to show cost nothing, the grid only lists the ones that can reach this region
+		const std::span<const uint32_t> nearbyLights{ pScene->GetLightGrid( ).GetLights( hitRecord.origin ) };
+		if ( nearbyLights.size( ) <= LIGHT_SAMPLES )
+		{
+			for ( const uint32_t lightIdx : nearbyLights )
+			{
+				const Light& light{ lights[lightIdx] };
+				if ( ( light.origin - hitRecord.origin ).SqrMagnitude( ) <= light.range * light.range )
+				{
+					lightFn( light, 1.f );
+				}
+			}
+			return;
+		}
+
+		// A few point lights picked by the light tree stand in for all of them,
+		// each weighted by how unlikely it was to be picked
+		const LightTree& lightTree{ pScene->GetLightTree( ) };
+		const uint32_t dimension{ sampler.NextDimension( ) };
+		for ( uint32_t i{}; i < LIGHT_SAMPLES; ++i )
+		{
+			float u, v;
+			sampler.Get2D( dimension, i, LIGHT_SAMPLES, u, v );
+			uint32_t lightIdx;
+			float probability;
+			if ( lightTree.Sample( hitRecord.origin, hitRecord.normal, u, lightIdx, probability ) )
+			{
+				lightFn( lights[lightIdx], 1.f / ( LIGHT_SAMPLES * probability ) );
+			}
+		}
+	}
+}
+
 Renderer::Renderer( SDL_Window* pWindow ) :
 	m_pWindow( pWindow ),
 	m_pBuffer( SDL_GetWindowSurface( pWindow ) )
 {
 	//Initialize
 	SDL_GetWindowSize( pWindow, &m_Width, &m_Height );
+	InitializePixels( );
+}
+
+Renderer::Renderer( int width, int height ) :
+	m_pBuffer( SDL_CreateRGBSurfaceWithFormat( 0, width, height, 32, SDL_PIXELFORMAT_ARGB8888 ) ),
+	m_OwnsBuffer( true ),
+	m_Width( width ),
+	m_Height( height )
+{
+	InitializePixels( );
+}
+
+dae::Renderer::~Renderer( )
+{
+	delete[] m_pBackBuffers[0];
+	delete[] m_pBackBuffers[1];
+	delete[] m_pAccumulationBuffer;
+	delete[] m_pLuminanceSquares;
+	delete[] m_pFrameColors;
+	delete[] m_pHistoryColors;
+	delete[] m_pFrameDepths;
+	delete[] m_pRenderColors;
+	delete m_pDenoiser;
+	delete[] m_pLightingSplits;
+	delete[] m_pPrimaryHits;
+
+	if ( m_OwnsBuffer )
+	{
+		SDL_FreeSurface( m_pBuffer );
+	}
+}
+
+void dae::Renderer::InitializePixels( )
+{
 	m_AspectRatio = float( m_Width ) / float( m_Height );
-	m_pBufferPixels = static_cast<uint32_t*>( m_pBuffer->pixels );
 
 	// Create a dynamic array with the amount of pixels
 	uint32_t amountOfPixels{ uint32_t( m_Width * m_Height ) };
-	m_pPixelIndices = new uint32_t[amountOfPixels];
-	// Fill with sequential values starting at 0
-	std::iota( m_pPixelIndices, m_pPixelIndices + amountOfPixels, 0 );
+	m_pBackBuffers[0] = new uint32_t[amountOfPixels]{};
+	m_pBackBuffers[1] = new uint32_t[amountOfPixels]{};
+	m_pBufferPixels = m_pBackBuffers[m_RenderBufferIdx];
+	m_pAccumulationBuffer = new ColorRGB[amountOfPixels]{};
+	m_pLuminanceSquares = new float[amountOfPixels]{};
+	m_pFrameColors = new ColorRGB[amountOfPixels]{};
+	m_pHistoryColors = new ColorRGB[amountOfPixels]{};
+	m_pFrameDepths = new float[amountOfPixels]{};
+
+	m_pRenderColors = new ColorRGB[amountOfPixels]{};
+	m_pDenoiser = new Denoiser{ amountOfPixels };
+	m_pLightingSplits = new LightingSplit[amountOfPixels]{};
+	m_pPrimaryHits = new HitRecord[amountOfPixels]{};
+
+	m_ShadowSamples = SHADOW_SAMPLES;
+	m_IndirectSamples = INDIRECT_SAMPLING;
+	SetRenderScale( 1.f );
 
 	SetLightingMode( LightingMode::Combined );
 }
 
-dae::Renderer::~Renderer( )
+void Renderer::Render( Scene* pScene )
 {
-	delete[] m_pPixelIndices;
-}
+	PROFILE_SCOPE( "Renderer::Render" );
 
-void Renderer::Render( Scene* pScene ) const
-{
 	Camera& camera = pScene->GetCamera( );
 	camera.CalculateCameraToWorld( );
 
+	UpdateDirtyTiles( pScene, camera );
+	UpdatePrimaryHits( pScene, camera );
+	if ( m_AccumulationEnabled )
+	{
+		UpdateAccumulation( pScene, camera );
+		++m_AccumulatedFrames;
+	}
+
+	DistributeTileSamples( );
+
+	// Checkerboard frames trace every other pixel, the rest is reconstructed from the previous frame.
+	// It needs a previous frame of the same scene, so the first frame after a change is traced in full.
+	m_CheckerboardParity = 1 - m_CheckerboardParity;
+	const bool wasCheckerboardHistoryValid{ m_IsCheckerboardHistoryValid && pScene == m_pCheckerboardScene };
+	m_IsCheckerboardFrame = m_CheckerboardEnabled && !m_AccumulationEnabled && wasCheckerboardHistoryValid;
+	m_IsCheckerboardHistoryValid = m_CheckerboardEnabled && !m_AccumulationEnabled;
+	m_pCheckerboardScene = pScene;
+
 #ifdef USE_PARALLEL_EXECUTION
 	// Parallel logic
-	uint32_t amountOfPixels{ uint32_t( m_Width * m_Height ) };
-
-	std::for_each( std::execution::par, m_pPixelIndices, m_pPixelIndices + amountOfPixels,
-	[this, pScene, &camera]( uint32_t pixelIdx )
+	PROFILE_SCOPE( "Renderer::Render (trace)" );
+	std::for_each( std::execution::par, m_Tiles.begin( ), m_Tiles.end( ),
+	[this, pScene, &camera]( Tile& tile )
 		{
-			RenderPixel( pScene, pixelIdx, camera );
+			RenderTile( pScene, tile, camera );
 		} );
 #else
 	// Single thread logic
-	uint32_t amountOfPixels{ uint32_t( m_Width * m_Height ) };
-	for ( uint32_t pixelIdx{}; pixelIdx < amountOfPixels; ++pixelIdx )
+	PROFILE_SCOPE( "Renderer::Render (trace)" );
+	for ( Tile& tile : m_Tiles )
 	{
-		RenderPixel( pScene, pixelIdx, camera );
+		RenderTile( pScene, tile, camera );
 	}
 #endif
+	if ( m_IsCheckerboardFrame )
+	{
+		PROFILE_SCOPE( "Renderer::Render (reconstruct)" );
+#ifdef USE_PARALLEL_EXECUTION
+		std::for_each( std::execution::par, m_Tiles.begin( ), m_Tiles.end( ),
+		[this, &camera]( const Tile& tile )
+			{
+				ReconstructTile( tile, camera );
+			} );
+#else
+		for ( const Tile& tile : m_Tiles )
+		{
+			ReconstructTile( tile, camera );
+		}
+#endif
+	}
+
+	if ( IsPostProcessed( ) )
+	{
+		const ColorRGB* pColors{ m_pRenderColors };
+		if ( IsDenoising( ) )
+		{
+			PROFILE_SCOPE( "Renderer::Render (denoise)" );
+			pColors = m_pDenoiser->Denoise( m_pRenderColors, m_pLightingSplits, m_pPrimaryHits, m_RenderWidth, m_RenderHeight );
+		}
+
+		PROFILE_SCOPE( "Renderer::Render (resolve)" );
+		Resolve( pColors );
+	}
+
+	// This frame is the history of the next one
+	if ( m_IsCheckerboardHistoryValid )
+	{
+		std::swap( m_pFrameColors, m_pHistoryColors );
+		m_HistoryCameraToWorld = camera.cameraToWorld;
+		m_HistoryFovCoefficient = camera.fovCoefficient;
+	}
 	//@END
+	//Hand the finished frame to Present and continue in the other buffer
+	{
+		std::lock_guard lock{ m_SwapMutex };
+		m_RenderBufferIdx = 1 - m_RenderBufferIdx;
+		m_HasNewFrame = true;
+	}
+	m_pBufferPixels = m_pBackBuffers[m_RenderBufferIdx];
+	// Fresh random numbers for the next frame
+	++m_FrameIdx;
+}
+
+bool dae::Renderer::Present( )
+{
+	PROFILE_SCOPE( "Renderer::Present" );
+
+	{
+		std::lock_guard lock{ m_SwapMutex };
+		if ( !m_HasNewFrame )
+		{
+			return false;
+		}
+
+		// The surface rows may be padded, copy line by line
+		const uint32_t* pFrontPixels{ m_pBackBuffers[1 - m_RenderBufferIdx] };
+		uint8_t* pSurfacePixels{ static_cast<uint8_t*>( m_pBuffer->pixels ) };
+		for ( int py{}; py < m_Height; ++py )
+		{
+			std::copy_n( pFrontPixels + py * m_Width, m_Width, reinterpret_cast<uint32_t*>( pSurfacePixels + py * m_pBuffer->pitch ) );
+		}
+		m_HasNewFrame = false;
+	}
+
 	//Update SDL Surface
-	SDL_UpdateWindowSurface( m_pWindow );
+	if ( m_pWindow )
+	{
+		PROFILE_SCOPE( "SDL_UpdateWindowSurface" );
+		SDL_UpdateWindowSurface( m_pWindow );
+	}
+	return true;
 }
 
-void dae::Renderer::RenderPixel( Scene* pScene, uint32_t pixelIdx, const Camera& camera ) const
+void dae::Renderer::CopyFrame( uint32_t* pPixels )
 {
-	float x, y;
-	ScreenToNDC( x, y, pixelIdx % m_Width, pixelIdx / m_Width, camera.fovCoefficient );
+	std::lock_guard lock{ m_SwapMutex };
+	const uint32_t* pFrontPixels{ m_pBackBuffers[1 - m_RenderBufferIdx] };
+	std::copy_n( pFrontPixels, m_Width * m_Height, pPixels );
+}
+
+void dae::Renderer::DistributeTileSamples( )
+{
+	m_ConvergedTileCount = 0;
+	if ( !m_AccumulationEnabled || !m_AdaptiveSamplingEnabled )
+	{
+		for ( Tile& tile : m_Tiles )
+		{
+			tile.frameSampleCount = 1;
+		}
+		return;
+	}
 
+	// A frame traces as many samples as one per pixel would, converged tiles leave their share to the noisy ones.
+	// Tiles without an estimate yet take one sample, the rest is split in proportion to the standard deviation,
+	// which gives the lowest total squared error for the samples spent.
+	float budget{ float( m_Tiles.size( ) ) };
+	float deviationSum{};
+	for ( const Tile& tile : m_Tiles )
+	{
+		if ( tile.isConverged )
+		{
+			++m_ConvergedTileCount;
+		}
+		else if ( tile.sampleCount < ADAPTIVE_MIN_SAMPLES )
+		{
+			budget -= 1.f;
+		}
+		else
+		{
+			deviationSum += tile.deviation;
+		}
+	}
+
+	for ( Tile& tile : m_Tiles )
+	{
+		tile.frameSampleCount = 1;
+		if ( !tile.isConverged && tile.sampleCount >= ADAPTIVE_MIN_SAMPLES && deviationSum > 0.f )
+		{
+			const float share{ budget * tile.deviation / deviationSum };
+			tile.frameSampleCount = std::clamp( uint32_t( share + .5f ), 1u, uint32_t( ADAPTIVE_MAX_SAMPLES ) );
+		}
+	}
+}
+
+void dae::Renderer::RenderTile( Scene* pScene, Tile& tile, const Camera& camera ) const
+{
+	if ( !m_AccumulationEnabled )
+	{
+		if ( m_IsIncrementalFrame && !tile.isDirty )
+		{
+			// Nothing in the tile changed, the last finished frame still has its pixels.
+			// Post processed frames keep them in the render colors, which are not swapped.
+			if ( !IsPostProcessed( ) )
+			{
+				const uint32_t* pFrontPixels{ m_pBackBuffers[1 - m_RenderBufferIdx] };
+				for ( int py{ tile.top }; py < tile.bottom; ++py )
+				{
+					const int rowStart{ tile.left + py * m_Width };
+					std::copy( pFrontPixels + rowStart, pFrontPixels + rowStart + ( tile.right - tile.left ), m_pBufferPixels + rowStart );
+				}
+			}
+			return;
+		}
+
+		tile.hasReflection = false;
+		for ( int py{ tile.top }; py < tile.bottom; ++py )
+		{
+			for ( int px{ tile.left }; px < tile.right; ++px )
+			{
+				// The other half is filled in by ReconstructTile
+				if ( m_IsCheckerboardFrame && ( px + py + m_CheckerboardParity ) % 2 )
+				{
+					continue;
+				}
+
+				const uint32_t pixelIdx{ uint32_t( px + py * m_RenderWidth ) };
+				ColorRGB finalColor{ RenderGBufferPixel( pScene, px, py, camera, 0, tile.hasPrimaryHits ) };
+				const HitRecord& primaryHit{ m_pPrimaryHits[pixelIdx] };
+				tile.hasReflection = tile.hasReflection || IsReflectiveHit( pScene, primaryHit );
+				if ( m_IsCheckerboardHistoryValid )
+				{
+					m_pFrameColors[pixelIdx] = finalColor;
+					m_pFrameDepths[pixelIdx] = primaryHit.didHit ? primaryHit.t : FLT_MAX;
+				}
+				WritePixel( finalColor, pixelIdx );
+			}
+		}
+		// Checkerboard frames only cache half of the hits
+		tile.hasPrimaryHits = tile.hasPrimaryHits || !m_IsCheckerboardFrame;
+		return;
+	}
+
+	// Converged tiles are not traced anymore, but both back buffers still need their pixels
+	if ( !tile.isConverged )
+	{
+		const bool isFirstSample{ tile.sampleCount == 0 };
+		if ( isFirstSample )
+		{
+			tile.hasReflection = false;
+		}
+		for ( int py{ tile.top }; py < tile.bottom; ++py )
+		{
+			for ( int px{ tile.left }; px < tile.right; ++px )
+			{
+				const uint32_t pixelIdx{ uint32_t( px + py * m_RenderWidth ) };
+				ColorRGB& accumulatedColor{ m_pAccumulationBuffer[pixelIdx] };
+				float& luminanceSquares{ m_pLuminanceSquares[pixelIdx] };
+				if ( isFirstSample )
+				{
+					accumulatedColor = {};
+					luminanceSquares = 0.f;
+				}
+
+				for ( uint32_t sample{}; sample < tile.frameSampleCount; ++sample )
+				{
+					// Every sample goes through the pixel center, the first one fills the G-buffer for the rest
+					const ColorRGB sampleColor{ RenderGBufferPixel( pScene, px, py, camera, tile.sampleCount + sample, tile.hasPrimaryHits || sample > 0 ) };
+					tile.hasReflection = tile.hasReflection || ( isFirstSample && IsReflectiveHit( pScene, m_pPrimaryHits[pixelIdx] ) );
+					const float luminance{ GetLuminance( sampleColor ) };
+					accumulatedColor += sampleColor;
+					luminanceSquares += luminance * luminance;
+				}
+			}
+		}
+		tile.sampleCount += tile.frameSampleCount;
+		tile.hasPrimaryHits = true;
+
+		if ( m_AdaptiveSamplingEnabled && tile.sampleCount >= ADAPTIVE_MIN_SAMPLES )
+		{
+			// Converged once the standard error of the mean is below the threshold
+			tile.deviation = EstimateTileDeviation( tile );
+			tile.isConverged = tile.deviation < ADAPTIVE_ERROR_THRESHOLD * sqrtf( float( tile.sampleCount ) );
+		}
+	}
+
+	// Show the average of every sample traced since the view last changed
+	const float sampleWeight{ 1.f / float( tile.sampleCount ) };
+	for ( int py{ tile.top }; py < tile.bottom; ++py )
+	{
+		for ( int px{ tile.left }; px < tile.right; ++px )
+		{
+			const uint32_t pixelIdx{ uint32_t( px + py * m_RenderWidth ) };
+			ColorRGB finalColor{ m_pAccumulationBuffer[pixelIdx] * sampleWeight };
+			WritePixel( finalColor, pixelIdx );
+		}
+	}
+}
+
+float dae::Renderer::EstimateTileDeviation( const Tile& tile ) const
+{
+	// Unbiased variance of each pixel's luminance in display units, averaged over the tile
+	const float sampleCount{ float( tile.sampleCount ) };
+	float varianceSum{};
+	for ( int py{ tile.top }; py < tile.bottom; ++py )
+	{
+		for ( int px{ tile.left }; px < tile.right; ++px )
+		{
+			const uint32_t pixelIdx{ uint32_t( px + py * m_RenderWidth ) };
+			const float mean{ GetLuminance( m_pAccumulationBuffer[pixelIdx] ) / sampleCount };
+			varianceSum += std::max( 0.f, m_pLuminanceSquares[pixelIdx] / sampleCount - mean * mean ) * sampleCount / ( sampleCount - 1.f );
+		}
+	}
+	return sqrtf( varianceSum / float( ( tile.right - tile.left ) * ( tile.bottom - tile.top ) ) );
+}
+
+void dae::Renderer::ReconstructTile( const Tile& tile, const Camera& camera ) const
+{
+	const Vector3 historyRight{ m_HistoryCameraToWorld.GetAxisX( ) };
+	const Vector3 historyUp{ m_HistoryCameraToWorld.GetAxisY( ) };
+	const Vector3 historyForward{ m_HistoryCameraToWorld.GetAxisZ( ) };
+	const Vector3 historyOrigin{ m_HistoryCameraToWorld.GetTranslation( ) };
+
+	for ( int py{ tile.top }; py < tile.bottom; ++py )
+	{
+		for ( int px{ tile.left }; px < tile.right; ++px )
+		{
+			if ( ( px + py + m_CheckerboardParity ) % 2 == 0 )
+			{
+				continue;
+			}
+
+			// The four direct neighbours were traced this frame
+			ColorRGB neighbourMin{ FLT_MAX, FLT_MAX, FLT_MAX };
+			ColorRGB neighbourMax{};
+			ColorRGB neighbourSum{};
+			float depthSum{};
+			int neighbourCount{};
+			int depthCount{};
+			const int neighbourOffsets[4][2]{ { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+			for ( const auto& offset : neighbourOffsets )
+			{
+				const int nx{ px + offset[0] };
+				const int ny{ py + offset[1] };
+				if ( nx < 0 || nx >= m_RenderWidth || ny < 0 || ny >= m_RenderHeight )
+				{
+					continue;
+				}
+
+				const uint32_t neighbourIdx{ uint32_t( nx + ny * m_RenderWidth ) };
+				const ColorRGB& neighbourColor{ m_pFrameColors[neighbourIdx] };
+				neighbourMin = { std::min( neighbourMin.r, neighbourColor.r ), std::min( neighbourMin.g, neighbourColor.g ), std::min( neighbourMin.b, neighbourColor.b ) };
+				neighbourMax = { std::max( neighbourMax.r, neighbourColor.r ), std::max( neighbourMax.g, neighbourColor.g ), std::max( neighbourMax.b, neighbourColor.b ) };
+				neighbourSum += neighbourColor;
+				++neighbourCount;
+
+				if ( m_pFrameDepths[neighbourIdx] < FLT_MAX )
+				{
+					depthSum += m_pFrameDepths[neighbourIdx];
+					++depthCount;
+				}
+			}
+
+			ColorRGB finalColor{ neighbourSum / float( neighbourCount ) };
+			if ( depthCount > 0 )
+			{
+				// Primary rays have a camera space z of 1, so the hit distance is the view depth.
+				// Estimate the world position from the neighbour depth and find it in the previous frame.
+				float x, y;
+				ScreenToNDC( x, y, px, py, camera.fovCoefficient );
+				const Vector3 worldPosition{ camera.origin + camera.cameraToWorld.TransformVector( { x, y, 1.f } ) * ( depthSum / float( depthCount ) ) };
+
+				const Vector3 toPosition{ worldPosition - historyOrigin };
+				const float historyDepth{ Vector3::Dot( toPosition, historyForward ) };
+				if ( historyDepth > 0.f )
+				{
+					const float historyX{ Vector3::Dot( toPosition, historyRight ) / historyDepth / ( m_AspectRatio * m_HistoryFovCoefficient ) };
+					const float historyY{ Vector3::Dot( toPosition, historyUp ) / historyDepth / m_HistoryFovCoefficient };
+					const float historyPx{ ( historyX + 1.f ) * .5f * m_RenderWidth - .5f };
+					const float historyPy{ ( 1.f - historyY ) * .5f * m_RenderHeight - .5f };
+
+					if ( historyPx >= 0.f && historyPx < m_RenderWidth - 1 && historyPy >= 0.f && historyPy < m_RenderHeight - 1 )
+					{
+						// Bilinear history sample, clamped to the neighbourhood to reject disocclusions and moving objects
+						const int hx{ int( historyPx ) };
+						const int hy{ int( historyPy ) };
+						const float fx{ historyPx - hx };
+						const float fy{ historyPy - hy };
+						const ColorRGB* pHistoryRow{ &m_pHistoryColors[hx + hy * m_RenderWidth] };
+						const ColorRGB historyColor{
+							ColorRGB::Lerp(
+								ColorRGB::Lerp( pHistoryRow[0], pHistoryRow[1], fx ),
+								ColorRGB::Lerp( pHistoryRow[m_RenderWidth], pHistoryRow[m_RenderWidth + 1], fx ),
+								fy ) };
+
+						finalColor = {
+							std::clamp( historyColor.r, neighbourMin.r, neighbourMax.r ),
+							std::clamp( historyColor.g, neighbourMin.g, neighbourMax.g ),
+							std::clamp( historyColor.b, neighbourMin.b, neighbourMax.b ) };
+					}
+				}
+			}
+
+			const uint32_t pixelIdx{ uint32_t( px + py * m_RenderWidth ) };
+			m_pFrameColors[pixelIdx] = finalColor;
+			// Reconstructed pixels have no lighting of their own to filter
+			m_pLightingSplits[pixelIdx].isFiltered = false;
+			WritePixel( finalColor, pixelIdx );
+		}
+	}
+}
+
+void dae::Renderer::WritePixel( ColorRGB& finalColor, uint32_t pixelIdx ) const
+{
+	// Post processed frames are kept in full precision for Resolve
+	if ( IsPostProcessed( ) )
+	{
+		m_pRenderColors[pixelIdx] = finalColor;
+	}
+	else
+	{
+		UpdateBuffer( finalColor, &m_pBufferPixels[pixelIdx] );
+	}
+}
+
+void dae::Renderer::Resolve( const ColorRGB* pColors ) const
+{
+	const float scaleX{ float( m_RenderWidth ) / float( m_Width ) };
+	const float scaleY{ float( m_RenderHeight ) / float( m_Height ) };
+
+	const auto resolveRow = [this, pColors, scaleX, scaleY]( int py )
+		{
+			if ( !IsScaled( ) )
+			{
+				for ( int px{}; px < m_Width; ++px )
+				{
+					ColorRGB finalColor{ pColors[px + py * m_Width] };
+					UpdateBuffer( finalColor, &m_pBufferPixels[px + py * m_Width] );
+				}
+				return;
+			}
+
+			const float sourceY{ std::clamp( ( py + .5f ) * scaleY - .5f, 0.f, float( m_RenderHeight - 1 ) ) };
+			const int y0{ int( sourceY ) };
+			const int y1{ std::min( y0 + 1, m_RenderHeight - 1 ) };
+			const float fy{ sourceY - y0 };
+
+			for ( int px{}; px < m_Width; ++px )
+			{
+				const float sourceX{ std::clamp( ( px + .5f ) * scaleX - .5f, 0.f, float( m_RenderWidth - 1 ) ) };
+				const int x0{ int( sourceX ) };
+				const int x1{ std::min( x0 + 1, m_RenderWidth - 1 ) };
+				const float fx{ sourceX - x0 };
+
+				const ColorRGB taps[4]{
+					pColors[x0 + y0 * m_RenderWidth],
+					pColors[x1 + y0 * m_RenderWidth],
+					pColors[x0 + y1 * m_RenderWidth],
+					pColors[x1 + y1 * m_RenderWidth] };
+				const float bilinearWeights[4]{ ( 1.f - fx ) * ( 1.f - fy ), fx * ( 1.f - fy ), ( 1.f - fx ) * fy, fx * fy };
+
+				// Edge aware: taps that differ a lot from the nearest one lose their weight,
+				// so edges stay sharp instead of being smeared over the upscaled pixels
+				const int nearestTap{ ( fx < .5f ? 0 : 1 ) + ( fy < .5f ? 0 : 2 ) };
+				const float nearestLuminance{ GetLuminance( taps[nearestTap] ) };
+
+				ColorRGB finalColor{};
+				float weightSum{};
+				for ( int tap{}; tap < 4; ++tap )
+				{
+					const float difference{ ( GetLuminance( taps[tap] ) - nearestLuminance ) / UPSCALE_EDGE_SIGMA };
+					const float weight{ bilinearWeights[tap] * expf( -difference * difference ) };
+					finalColor += taps[tap] * weight;
+					weightSum += weight;
+				}
+				finalColor /= weightSum;
+
+				UpdateBuffer( finalColor, &m_pBufferPixels[px + py * m_Width] );
+			}
+		};
+
+#ifdef USE_PARALLEL_EXECUTION
+	std::vector<int> rows( m_Height );
+	std::iota( rows.begin( ), rows.end( ), 0 );
+	std::for_each( std::execution::par, rows.begin( ), rows.end( ), resolveRow );
+#else
+	for ( int py{}; py < m_Height; ++py )
+	{
+		resolveRow( py );
+	}
+#endif
+}
+
+ColorRGB dae::Renderer::RenderPixel( Scene* pScene, int px, int py, const Camera& camera, uint32_t sampleIdx, HitRecord* pPrimaryHit ) const
+{
 	// Color to be filled in the buffer
 	ColorRGB finalColor{};
-	ProcessRay( pScene, { camera.origin, camera.cameraToWorld.TransformVector( { x, y, 1.f } ) }, finalColor );
+	Sampler sampler{ CreateSampler( px, py, sampleIdx ) };
+	ProcessRay( pScene, GetPrimaryRay( px, py, camera ), finalColor, sampler, 0, 1.f, pPrimaryHit );
+
+	// Normalize color
+	finalColor.MaxToOne( );
+	return finalColor;
+}
+
+void dae::Renderer::RenderRegion( Scene* pScene, int left, int top, int right, int bottom, uint32_t* pPixels ) const
+{
+	PROFILE_SCOPE( "Renderer::RenderRegion" );
+
+	Camera& camera = pScene->GetCamera( );
+	camera.CalculateCameraToWorld( );
+
+	const int regionWidth{ right - left };
+	const auto renderRow = [this, pScene, left, top, right, regionWidth, pPixels, &camera]( int py )
+		{
+			uint32_t* pRowPixels{ pPixels + ( py - top ) * regionWidth };
+			for ( int px{ left }; px < right; ++px )
+			{
+				ColorRGB finalColor{ RenderPixel( pScene, px, py, camera ) };
+				UpdateBuffer( finalColor, &pRowPixels[px - left] );
+			}
+		};
+
+#ifdef USE_PARALLEL_EXECUTION
+	std::vector<int> rows( bottom - top );
+	std::iota( rows.begin( ), rows.end( ), top );
+	std::for_each( std::execution::par, rows.begin( ), rows.end( ), renderRow );
+#else
+	for ( int py{ top }; py < bottom; ++py )
+	{
+		renderRow( py );
+	}
+#endif
+}
+
+ColorRGB dae::Renderer::RenderGBufferPixel( Scene* pScene, int px, int py, const Camera& camera, uint32_t sampleIdx, bool isHitCached ) const
+{
+	const uint32_t pixelIdx{ uint32_t( px + py * m_RenderWidth ) };
+	HitRecord& primaryHit{ m_pPrimaryHits[pixelIdx] };
+	LightingSplit* pSplit{ IsDenoising( ) ? &m_pLightingSplits[pixelIdx] : nullptr };
+
+	ColorRGB finalColor{};
+	Sampler sampler{ CreateSampler( px, py, sampleIdx ) };
+	if ( isHitCached )
+	{
+		ShadeHit( pScene, GetPrimaryRay( px, py, camera ), primaryHit, finalColor, sampler, 0, 1.f, pSplit );
+	}
+	else
+	{
+		ProcessRay( pScene, GetPrimaryRay( px, py, camera ), finalColor, sampler, 0, 1.f, &primaryHit, pSplit );
+	}
 
-	// Normalize color and update Buffer
+	// Normalize color
 	finalColor.MaxToOne( );
+	return finalColor;
+}
+
+Ray dae::Renderer::GetPrimaryRay( int px, int py, const Camera& camera ) const
+{
+	float x, y;
+	ScreenToNDC( x, y, px, py, camera.fovCoefficient );
+	return { camera.origin, camera.cameraToWorld.TransformVector( { x, y, 1.f } ) };
+}
+
+Sampler dae::Renderer::CreateSampler( int px, int py, uint32_t sampleIdx ) const
+{
+	const uint32_t frameIdx{ m_AccumulationEnabled ? 0u : m_FrameIdx };
+	return { m_SampleSequence, px, py, uint32_t( px + py * m_RenderWidth ), frameIdx, sampleIdx };
+}
+
+void dae::Renderer::ProcessRay( Scene* pScene, Ray ray, ColorRGB& finalColor, Sampler& sampler, int bounce, float throughput, HitRecord* pHitRecord, LightingSplit* pSplit ) const
+{
+	CountRay( bounce == 0 ? tl_RayCounters.primary : tl_RayCounters.secondary );
+
+	HitRecord closestHit{};
+	pScene->GetClosestHit( ray, closestHit );
+	if ( pHitRecord )
+	{
+		*pHitRecord = closestHit;
+	}
+	ShadeHit( pScene, ray, closestHit, finalColor, sampler, bounce, throughput, pSplit );
+}
+
+int dae::Renderer::GetSetSampleCount( int samples ) const
+{
+	if ( m_SampleSequence == SampleSequence::SobolOwen )
+	{
+		return int( std::bit_ceil( unsigned( samples ) ) );
+	}
+	return samples;
+}
+
+bool dae::Renderer::ShouldTrace( float throughput, int bounce, Sampler& sampler, float& compensation ) const
+{
+	compensation = 1.f;
+	if ( throughput < MIN_RAY_CONTRIBUTION )
+	{
+		return false;
+	}
+	if ( bounce < RUSSIAN_ROULETTE_MIN_BOUNCE )
+	{
+		return true;
+	}
+
+	// Survivors make up for the paths that were cut, the expected color stays the same
+	const float probability{ std::clamp( throughput, RUSSIAN_ROULETTE_MIN_PROBABILITY, 1.f ) };
+	if ( sampler.Next1D( ) >= probability )
+	{
+		return false;
+	}
+	compensation = 1.f / probability;
+	return true;
+}
+
+void dae::Renderer::ShadeHit( Scene* pScene, const Ray& ray, const HitRecord& hitRecord, ColorRGB& finalColor, Sampler& sampler, int bounce, float throughput, LightingSplit* pSplit ) const
+{
+	if ( pSplit )
+	{
+		*pSplit = {};
+		if ( hitRecord.didHit )
+		{
+			const Material* pMaterial{ pScene->GetMaterials( )[hitRecord.materialIndex] };
+			pSplit->isFiltered = !pMaterial->IsReflective( );
+			pSplit->albedo = pMaterial->GetAlbedo( );
+		}
+	}
 
-	// Update Color in Buffer
-	UpdateBuffer( finalColor, &m_pBufferPixels[pixelIdx] );
-}
+	if ( m_IntegratorMode == IntegratorMode::PathTracer )
+	{
+		// Every part of a path is noisy, it is filtered as a whole
+		finalColor = TracePath( pScene, ray, hitRecord, sampler );
+		if ( pSplit )
+		{
+			pSplit->indirect = finalColor;
+		}
+		return;
+	}
 
-void dae::Renderer::ProcessRay( Scene* pScene, Ray ray, ColorRGB& finalColor, int bounce ) const
-{
 	LightingInfo info{};
-	info.hitRay = std::move( ray );
+	info.hitRay = ray;
+	info.closestHit = hitRecord;
 
-	pScene->GetClosestHit( ray, info.closestHit );
 	if ( info.closestHit.didHit )
 	{
 		// Hit visualization
 		finalColor = {};
 
 		// Calculate the shade of the pixel
-		for ( const dae::Light& light : pScene->GetLights( ) )
+		ForEachLightSample( pScene, info.closestHit, sampler, [&]( const Light& light, float lightWeight )
+			{
+				const ColorRGB previousColor{ finalColor };
+				ShadeLight( pScene, info, light, lightWeight, finalColor, sampler, bounce, throughput );
+				if ( pSplit )
+				{
+					// Soft shadows scale the light by their shadow factor, which is never zero
+					const ColorRGB lightColor{ finalColor - previousColor };
+					pSplit->direct += lightColor;
+					pSplit->unshadowedDirect += lightColor / info.shadowFactor;
+				}
+			} );
+
+		// Indirect light is gathered once per hit, whatever the number of lights.
+		// Mirrors get theirs from the reflection bounce, a cosine distribution would miss their narrow lobe.
+		Material* pMaterial{ pScene->GetMaterials( )[info.closestHit.materialIndex] };
+		if ( m_GlobalIlluminationEnabled && bounce < MAX_RAY_BOUNCES && !pMaterial->IsReflective( ) )
 		{
-			info.hitToLight = LightUtils::GetDirectionToLight( light, info.closestHit.origin );
-			info.hitToLightDistance = info.hitToLight.Normalize( );
-			info.pLight = &light;
+			const Vector3 view{ -info.hitRay.direction };
+			ColorRGB indirectColor{};
+			const uint32_t dimension{ sampler.NextDimension( ) };
+			const int indirectSamples{ GetSetSampleCount( m_IndirectSamples ) };
+			for ( int i{}; i < indirectSamples; ++i )
+			{
+				float u, v;
+				sampler.Get2D( dimension, i, indirectSamples, u, v );
+				const Ray indirectRay{ info.closestHit.origin + info.closestHit.normal * .0005f, LightUtils::GetCosineWeightedDirection( info.closestHit.normal, u, v ) };
 
-			Ray shadowRay{ info.closestHit.origin + info.closestHit.normal * .0005f, info.hitToLight, .0001f, info.hitToLightDistance };
-			bool forceRender{ m_ShadowsMode == ShadowMode::None };
+				// BRDF * cos(theta) / pdf, the cosine cancels against the pdf of cos(theta) / PI
+				ShadeInfo shadeInfo{};
+				const ColorRGB weight{ pMaterial->Shade( shadeInfo, info.closestHit, indirectRay.direction, view ) * PI / float( indirectSamples ) };
+				const float sampleThroughput{ throughput * GetMaxComponent( weight ) };
+				float compensation;
+				if ( !ShouldTrace( sampleThroughput, bounce, sampler, compensation ) )
+				{
+					continue;
+				}
 
-			switch ( m_ShadowsMode )
+				ColorRGB incomingColor{};
+				ProcessRay( pScene, indirectRay, incomingColor, sampler, bounce + 1, sampleThroughput * compensation );
+				indirectColor += incomingColor * weight * compensation;
+			}
+			finalColor += indirectColor;
+			if ( pSplit )
 			{
-			case ShadowMode::Soft:
-				// Render soft shadows and update shadowfactor in the info struct
-				RenderSoftShadows( pScene, info );
-				forceRender = true;
-				[[fallthrough]];
-			case ShadowMode::None:
-			case ShadowMode::Hard:
-				// if shadow ray doesn't hit anything, we have a clear view of the light
-				// if force render becasuse of soft shadows, continue
-				if ( forceRender || !pScene->DoesHit( std::move( shadowRay ) ) )
-				{
-					info.observedAreaMeasure = Vector3::Dot( info.closestHit.normal, info.hitToLight );
-					if ( info.observedAreaMeasure >= 0.f )
-					{
-						ShadeInfo shadeInfo{};
+				pSplit->indirect = indirectColor;
+			}
+		}
+	}
+}
+
+void dae::Renderer::ShadeLight( Scene* pScene, LightingInfo& info, const Light& light, float lightWeight, ColorRGB& finalColor, Sampler& sampler, int bounce, float throughput ) const
+{
+	info.hitToLight = LightUtils::GetDirectionToLight( light, info.closestHit.origin );
+	info.hitToLightDistance = info.hitToLight.Normalize( );
+	info.pLight = &light;
+	info.lightWeight = lightWeight;
+	info.shadowFactor = 1.f;
+
+	Ray shadowRay{ info.closestHit.origin + info.closestHit.normal * .0005f, info.hitToLight, .0001f, info.hitToLightDistance };
+	bool forceRender{ m_ShadowsMode == ShadowMode::None };
 
-						// Set material and call the lighting function to obtain pixel color
-						info.pMaterial = pScene->GetMaterials( )[info.closestHit.materialIndex];
+	switch ( m_ShadowsMode )
+	{
+	case ShadowMode::Soft:
+		// Render soft shadows and update shadowfactor in the info struct
+		RenderSoftShadows( pScene, info, sampler );
+		forceRender = true;
+		[[fallthrough]];
+	case ShadowMode::None:
+	case ShadowMode::Hard:
+		// if shadow ray doesn't hit anything, we have a clear view of the light
+		// if force render becasuse of soft shadows, continue
+		if ( !forceRender )
+		{
+			CountRay( tl_RayCounters.shadow );
+		}
+		if ( forceRender || !pScene->DoesHit( std::move( shadowRay ) ) )
+		{
+			info.observedAreaMeasure = Vector3::Dot( info.closestHit.normal, info.hitToLight );
+			if ( info.observedAreaMeasure >= 0.f )
+			{
+				ShadeInfo shadeInfo{};
+
+				// Set material and call the lighting function to obtain pixel color
+				info.pMaterial = pScene->GetMaterials( )[info.closestHit.materialIndex];
 
-						m_LightingFn( shadeInfo, info, finalColor );
+				m_LightingFn( shadeInfo, info, finalColor );
 
-						// Recursive call for reflections
-						if ( bounce < MAX_RAY_BOUNCES )
+				// Recursive call for reflections
+				if ( bounce < MAX_RAY_BOUNCES )
+				{
+					if ( shadeInfo.needsBounce )
+					{
+						// Stays black when the reflection is not worth tracing
+						ColorRGB reflectionColor{};
+						const float reflectionThroughput{ throughput * shadeInfo.reflectance };
+						float compensation;
+						if ( ShouldTrace( reflectionThroughput, bounce, sampler, compensation ) )
 						{
-							if ( shadeInfo.needsBounce )
-							{
-								ColorRGB reflectionColor{};
-								ProcessRay( pScene, shadeInfo.reflectionRay, reflectionColor, bounce + 1 );
-								finalColor = finalColor * ( 1.f - shadeInfo.reflectance ) + reflectionColor * shadeInfo.reflectance;
-							}
-							if ( m_GlobalIlluminationEnabled )
-							{
-								ColorRGB indirectColor{};
-								for ( int i{}; i < INDIRECT_SAMPLING; ++i )
-								{
-									Ray randomDirection{ info.closestHit.origin, LightUtils::GetRandomPointInRadius( light.origin, INDIRECT_MAX_DEVIATION ) };
-									randomDirection.direction.Normalize( );
-									randomDirection.origin += randomDirection.direction * INDIRECT_MAX_DEVIATION;
-									ProcessRay( pScene, randomDirection, indirectColor, bounce + 1 );
-
-									// Use weight of the cosine of the angle between the normal and the random direction
-									finalColor += indirectColor
-										* std::max( 0.f, Vector3::Dot( info.closestHit.normal, randomDirection.direction ) )
-										* INDIRECT_LIGHTING_FACTOR;
-								}
-							}
+							ProcessRay( pScene, shadeInfo.reflectionRay, reflectionColor, sampler, bounce + 1, reflectionThroughput * compensation );
+							reflectionColor *= compensation;
 						}
+						finalColor = finalColor * ( 1.f - shadeInfo.reflectance ) + reflectionColor * shadeInfo.reflectance;
 					}
 				}
-				break;
 			}
 		}
+		break;
+	}
+}
+
+ColorRGB dae::Renderer::TracePath( Scene* pScene, Ray ray, HitRecord hitRecord, Sampler& sampler ) const
+{
+	ColorRGB radiance{};
+	// What the light reaching the current hit is still worth in the pixel
+	ColorRGB pathWeight{ 1.f, 1.f, 1.f };
+	for ( int bounce{}; hitRecord.didHit; ++bounce )
+	{
+		Material* pMaterial{ pScene->GetMaterials( )[hitRecord.materialIndex] };
+		const Vector3 view{ -ray.direction };
+		// Back faces are shaded like front faces
+		if ( Vector3::Dot( hitRecord.normal, view ) < 0.f )
+		{
+			hitRecord.normal = -hitRecord.normal;
+		}
+
+		// Point and directional lights can't be hit by a ray, they only arrive through next event estimation
+		radiance += pathWeight * SampleDirectLight( pScene, hitRecord, view, pMaterial, sampler );
+		if ( bounce + 1 >= PATH_MAX_BOUNCES )
+		{
+			break;
+		}
+
+		// BRDF * cos(theta) / pdf, with the pdf of every lobe that could have picked the direction
+		const float lobe{ sampler.Next1D( ) };
+		float u, v;
+		sampler.Get2D( sampler.NextDimension( ), 0, 1, u, v );
+		Vector3 direction;
+		if ( !pMaterial->SampleDirection( hitRecord, view, lobe, u, v, direction ) )
+		{
+			break;
+		}
+		const float pdf{ pMaterial->GetDirectionPdf( hitRecord, direction, view ) };
+		if ( !( pdf > 0.f ) )
+		{
+			break;
+		}
+		ShadeInfo shadeInfo{};
+		pathWeight *= pMaterial->Shade( shadeInfo, hitRecord, direction, view ) * ( Vector3::Dot( hitRecord.normal, direction ) / pdf );
+
+		float compensation;
+		if ( !ShouldTrace( GetMaxComponent( pathWeight ), bounce, sampler, compensation ) )
+		{
+			break;
+		}
+		pathWeight *= compensation;
+
+		ray = { hitRecord.origin + hitRecord.normal * .0005f, direction };
+		hitRecord = {};
+		CountRay( tl_RayCounters.secondary );
+		pScene->GetClosestHit( ray, hitRecord );
 	}
+	return radiance;
+}
+
+ColorRGB dae::Renderer::SampleDirectLight( Scene* pScene, const HitRecord& hitRecord, const Vector3& view, Material* pMaterial, Sampler& sampler ) const
+{
+	ColorRGB directLight{};
+	ForEachLightSample( pScene, hitRecord, sampler, [&]( const Light& light, float lightWeight )
+		{
+			Vector3 hitToLight{ LightUtils::GetDirectionToLight( light, hitRecord.origin ) };
+			const float hitToLightDistance{ hitToLight.Normalize( ) };
+			const float observedArea{ Vector3::Dot( hitRecord.normal, hitToLight ) };
+			if ( observedArea <= 0.f )
+			{
+				return;
+			}
+
+			if ( m_ShadowsMode != ShadowMode::None )
+			{
+				// Soft shadows aim at one point of the light's sphere per sample, accumulation averages them out
+				Vector3 shadowTarget{ light.origin };
+				if ( m_ShadowsMode == ShadowMode::Soft && light.type == LightType::Point )
+				{
+					float u, v;
+					sampler.Get2D( sampler.NextDimension( ), 0, 1, u, v );
+					shadowTarget = LightUtils::GetPointInRadius( light.origin, SHADOW_RADIUS, u, v );
+				}
+				Vector3 shadowDirection{ hitToLight };
+				float shadowDistance{ hitToLightDistance };
+				if ( light.type == LightType::Point )
+				{
+					shadowDirection = shadowTarget - hitRecord.origin;
+					shadowDistance = shadowDirection.Normalize( );
+				}
+				CountRay( tl_RayCounters.shadow );
+				if ( pScene->DoesHit( { hitRecord.origin + hitRecord.normal * .0005f, shadowDirection, .0001f, shadowDistance } ) )
+				{
+					return;
+				}
+			}
+
+			ShadeInfo shadeInfo{};
+			directLight += pMaterial->Shade( shadeInfo, hitRecord, hitToLight, view )
+				* LightUtils::GetRadiance( light, hitToLightDistance * hitToLightDistance ) * ( observedArea * lightWeight );
+		} );
+	return directLight;
 }
 
 bool Renderer::SaveBufferToImage( ) const
@@ -178,11 +1058,11 @@ void dae::Renderer::ToggleShadows( )
 {
 	if ( m_ShadowsMode == ShadowMode::None )
 	{
-		m_ShadowsMode = ShadowMode( static_cast<int>( 0 ) );
+		SetShadowMode( ShadowMode( static_cast<int>( 0 ) ) );
 	}
 	else
 	{
-		m_ShadowsMode = ShadowMode( static_cast<int>( m_ShadowsMode ) + 1 );
+		SetShadowMode( ShadowMode( static_cast<int>( m_ShadowsMode ) + 1 ) );
 	}
 }
 
@@ -200,7 +1080,166 @@ void dae::Renderer::ToggleLightingMode( )
 
 void dae::Renderer::ToggleGlobalIllumination( )
 {
-	m_GlobalIlluminationEnabled = !m_GlobalIlluminationEnabled;
+	SetGlobalIllumination( !m_GlobalIlluminationEnabled );
+}
+
+void dae::Renderer::ToggleAccumulation( )
+{
+	SetAccumulation( !m_AccumulationEnabled );
+}
+
+void dae::Renderer::ToggleCheckerboard( )
+{
+	SetCheckerboard( !m_CheckerboardEnabled );
+}
+
+void dae::Renderer::SetCheckerboard( bool enabled )
+{
+	m_CheckerboardEnabled = enabled;
+	m_IsCheckerboardHistoryValid = false;
+}
+
+void dae::Renderer::ToggleDirtyRegions( )
+{
+	SetDirtyRegions( !m_DirtyRegionsEnabled );
+}
+
+void dae::Renderer::SetDirtyRegions( bool enabled )
+{
+	m_DirtyRegionsEnabled = enabled;
+	m_AreDirtyRegionsTracked = false;
+}
+
+void dae::Renderer::ToggleDenoiser( )
+{
+	SetDenoiser( !m_DenoiserEnabled );
+}
+
+void dae::Renderer::SetDenoiser( bool enabled )
+{
+	m_DenoiserEnabled = enabled;
+	// Clean dirty region tiles must be traced again into the render colors
+	ResetAccumulation( );
+}
+
+void dae::Renderer::SetRenderScale( float scale )
+{
+	const int renderWidth{ std::clamp( int( float( m_Width ) * scale + .5f ), 1, m_Width ) };
+	const int renderHeight{ std::clamp( int( float( m_Height ) * scale + .5f ), 1, m_Height ) };
+	if ( renderWidth == m_RenderWidth && renderHeight == m_RenderHeight )
+	{
+		return;
+	}
+
+	m_RenderWidth = renderWidth;
+	m_RenderHeight = renderHeight;
+
+	// Split the render target in tiles, the edge tiles are cut to its size
+	m_Tiles.clear( );
+	for ( int top{}; top < m_RenderHeight; top += TILE_SIZE )
+	{
+		for ( int left{}; left < m_RenderWidth; left += TILE_SIZE )
+		{
+			m_Tiles.push_back( { left, top, std::min( left + TILE_SIZE, m_RenderWidth ), std::min( top + TILE_SIZE, m_RenderHeight ) } );
+		}
+	}
+	ResetAccumulation( );
+}
+
+void dae::Renderer::SetShadowSamples( int samples )
+{
+	m_ShadowSamples = std::max( 1, samples );
+	ResetAccumulation( );
+}
+
+void dae::Renderer::SetIndirectSamples( int samples )
+{
+	m_IndirectSamples = std::max( 1, samples );
+	ResetAccumulation( );
+}
+
+void dae::Renderer::SetShadowMode( ShadowMode mode )
+{
+	m_ShadowsMode = mode;
+	ResetAccumulation( );
+}
+
+void dae::Renderer::ToggleSampleSequence( )
+{
+	if ( m_SampleSequence == SampleSequence::BlueNoise )
+	{
+		SetSampleSequence( SampleSequence( static_cast<int>( 0 ) ) );
+	}
+	else
+	{
+		SetSampleSequence( SampleSequence( static_cast<int>( m_SampleSequence ) + 1 ) );
+	}
+}
+
+void dae::Renderer::SetSampleSequence( SampleSequence sequence )
+{
+	m_SampleSequence = sequence;
+	ResetAccumulation( );
+}
+
+void dae::Renderer::ToggleIntegratorMode( )
+{
+	if ( m_IntegratorMode == IntegratorMode::PathTracer )
+	{
+		SetIntegratorMode( IntegratorMode( static_cast<int>( 0 ) ) );
+	}
+	else
+	{
+		SetIntegratorMode( IntegratorMode( static_cast<int>( m_IntegratorMode ) + 1 ) );
+	}
+}
+
+void dae::Renderer::SetIntegratorMode( IntegratorMode mode )
+{
+	m_IntegratorMode = mode;
+	ResetAccumulation( );
+}
+
+void dae::Renderer::SetGlobalIllumination( bool enabled )
+{
+	m_GlobalIlluminationEnabled = enabled;
+	ResetAccumulation( );
+}
+
+void dae::Renderer::SetAccumulation( bool enabled )
+{
+	m_AccumulationEnabled = enabled;
+	ResetAccumulation( );
+}
+
+void dae::Renderer::ToggleAdaptiveSampling( )
+{
+	SetAdaptiveSampling( !m_AdaptiveSamplingEnabled );
+}
+
+void dae::Renderer::SetAdaptiveSampling( bool enabled )
+{
+	m_AdaptiveSamplingEnabled = enabled;
+	ResetAccumulation( );
+}
+
+void dae::Renderer::ResetAccumulation( )
+{
+	m_AccumulatedFrames = 0;
+	m_IsCheckerboardHistoryValid = false;
+	m_AreDirtyRegionsTracked = false;
+	for ( Tile& tile : m_Tiles )
+	{
+		tile.sampleCount = 0;
+		tile.isConverged = false;
+		tile.isDirty = true;
+	}
+}
+
+void dae::Renderer::ResetSceneCaches( )
+{
+	m_pPrimaryHitScene = nullptr;
+	ResetAccumulation( );
 }
 
 LightingMode dae::Renderer::GetLightingMode( )
@@ -208,52 +1247,84 @@ LightingMode dae::Renderer::GetLightingMode( )
 	return m_LightingMode;
 }
 
+RayCounters dae::Renderer::GetRayCounters( )
+{
+	std::lock_guard lock{ s_RayCounterMutex };
+
+	RayCounters counters{ s_RetiredRayCounters };
+	for ( const RayCounterSlot* pSlot : s_RayCounterSlots )
+	{
+		counters.primary += pSlot->primary.load( std::memory_order_relaxed );
+		counters.shadow += pSlot->shadow.load( std::memory_order_relaxed );
+		counters.secondary += pSlot->secondary.load( std::memory_order_relaxed );
+	}
+	return counters;
+}
+
+void dae::Renderer::ResetRayCounters( )
+{
+	std::lock_guard lock{ s_RayCounterMutex };
+
+	s_RetiredRayCounters = {};
+	for ( RayCounterSlot* pSlot : s_RayCounterSlots )
+	{
+		pSlot->primary.store( 0, std::memory_order_relaxed );
+		pSlot->shadow.store( 0, std::memory_order_relaxed );
+		pSlot->secondary.store( 0, std::memory_order_relaxed );
+	}
+}
+
 inline void dae::Renderer::ScreenToNDC( float& x, float& y, int px, int py, float fov ) const
 {
-	x = ( 2.f * ( px + 0.5f ) / m_Width - 1.f ) * m_AspectRatio * fov;
-	y = ( 1.f - 2.f * ( py + 0.5f ) / m_Height ) * fov;
+	x = ( 2.f * ( px + 0.5f ) / m_RenderWidth - 1.f ) * m_AspectRatio * fov;
+	y = ( 1.f - 2.f * ( py + 0.5f ) / m_RenderHeight ) * fov;
 }
 
 void dae::Renderer::ObservedAreaLightingFn( ShadeInfo& shadeInfo, const LightingInfo& info, ColorRGB& finalColor ) const
 {
-	finalColor += ColorRGB{ 1.f, 1.f, 1.f } * info.observedAreaMeasure * info.shadowFactor;
+	finalColor += ColorRGB{ 1.f, 1.f, 1.f } * info.observedAreaMeasure * info.shadowFactor * info.lightWeight;
 }
 
 void dae::Renderer::RadianceLightingFn( ShadeInfo& shadeInfo, const LightingInfo& info, ColorRGB& finalColor ) const
 {
-	finalColor += LightUtils::GetRadiance( *info.pLight, powf( info.hitToLightDistance, 2 ) ) * info.shadowFactor;
+	finalColor += LightUtils::GetRadiance( *info.pLight, Square( info.hitToLightDistance ) ) * info.shadowFactor * info.lightWeight;
 }
 
 void dae::Renderer::BRDFLightingFn( ShadeInfo& shadeInfo, const LightingInfo& info, ColorRGB& finalColor ) const
 {
-	finalColor += info.pMaterial->Shade( shadeInfo, info.closestHit, info.hitToLight, -info.hitRay.direction ) * info.shadowFactor;
+	finalColor += info.pMaterial->Shade( shadeInfo, info.closestHit, info.hitToLight, -info.hitRay.direction ) * info.shadowFactor * info.lightWeight;
 }
 
 void dae::Renderer::CombinedLightingFn( ShadeInfo& shadeInfo, const LightingInfo& info, ColorRGB& finalColor ) const
 {
-	const ColorRGB Ergb{ LightUtils::GetRadiance( *info.pLight, powf( info.hitToLightDistance, 2 ) ) };
+	const ColorRGB Ergb{ LightUtils::GetRadiance( *info.pLight, Square( info.hitToLightDistance ) ) };
 	const ColorRGB BRDFrgb{ info.pMaterial->Shade( shadeInfo, info.closestHit, info.hitToLight, -info.hitRay.direction ) };
 
-	finalColor += Ergb * BRDFrgb * info.observedAreaMeasure * info.shadowFactor;
+	finalColor += Ergb * BRDFrgb * info.observedAreaMeasure * info.shadowFactor * info.lightWeight;
 }
 
-void dae::Renderer::RenderSoftShadows( Scene* pScene, LightingInfo& info ) const
+void dae::Renderer::RenderSoftShadows( Scene* pScene, LightingInfo& info, Sampler& sampler ) const
 {
-	for ( int i = 0; i < SHADOW_SAMPLES; ++i )
+	const uint32_t dimension{ sampler.NextDimension( ) };
+	const int shadowSamples{ GetSetSampleCount( m_ShadowSamples ) };
+	for ( int i = 0; i < shadowSamples; ++i )
 	{
-		Vector3 randomizedLightPosition = LightUtils::GetRandomPointInRadius( info.pLight->origin, SHADOW_RADIUS );
+		float u, v;
+		sampler.Get2D( dimension, i, shadowSamples, u, v );
+		Vector3 randomizedLightPosition = LightUtils::GetPointInRadius( info.pLight->origin, SHADOW_RADIUS, u, v );
 		
 		Vector3 rhitToLight{ randomizedLightPosition - info.closestHit.origin };
 		float rhitToLightDistance{ rhitToLight.Normalize( ) };
 
 		Ray shadowRay( info.closestHit.origin + info.closestHit.normal * SHADOW_RADIUS, rhitToLight, 0.0001f, rhitToLightDistance );
+		CountRay( tl_RayCounters.shadow );
 		if ( !pScene->DoesHit( shadowRay ) )
 		{
 			//info.shadowFactor += std::clamp( std::abs( Vector3::Dot( info.closestHit.normal, rhitToLight ) ), 0.6f, 1.f);
 			info.shadowFactor += std::max(0.f, Vector3::Dot( info.closestHit.normal, rhitToLight ) );
 		}
 	}
-	info.shadowFactor /= SHADOW_SAMPLES + 1;
+	info.shadowFactor /= shadowSamples + 1;
 }
 
 void dae::Renderer::UpdateBuffer( dae::ColorRGB& finalColor, uint32_t* const pBufferHead ) const
@@ -267,9 +1338,264 @@ void dae::Renderer::UpdateBuffer( dae::ColorRGB& finalColor, uint32_t* const pBu
 		static_cast<uint8_t>( finalColor.b * 255 ) );
 }
 
+void dae::Renderer::UpdateAccumulation( const Scene* pScene, const Camera& camera )
+{
+	const uint64_t sceneRevision{ pScene->GetRevision( ) };
+	if ( pScene != m_pAccumulatedScene
+		|| !( camera.cameraToWorld == m_AccumulatedCameraToWorld )
+		|| camera.fovCoefficient != m_AccumulatedFovCoefficient )
+	{
+		m_pAccumulatedScene = pScene;
+		m_AccumulatedSceneRevision = sceneRevision;
+		m_AccumulatedCameraToWorld = camera.cameraToWorld;
+		m_AccumulatedFovCoefficient = camera.fovCoefficient;
+		ResetAccumulation( );
+	}
+	else if ( sceneRevision != m_AccumulatedSceneRevision )
+	{
+		m_AccumulatedSceneRevision = sceneRevision;
+		if ( !m_IsIncrementalFrame )
+		{
+			ResetAccumulation( );
+			return;
+		}
+
+		// Only the tiles the moved meshes can reach start over
+		for ( Tile& tile : m_Tiles )
+		{
+			if ( tile.isDirty )
+			{
+				tile.sampleCount = 0;
+				tile.isConverged = false;
+			}
+		}
+	}
+}
+
+void dae::Renderer::UpdateDirtyTiles( const Scene* pScene, const Camera& camera )
+{
+	const std::vector<TriangleMesh>& meshes{ pScene->GetTriangleMeshGeometries( ) };
+	const auto trackMesh = []( const TriangleMesh& mesh )
+		{
+			TrackedMesh trackedMesh{ mesh.revision };
+			if ( mesh.pBVHRoot && !mesh.indices.empty( ) )
+			{
+				trackedMesh.hasBounds = true;
+				trackedMesh.boundsMin = mesh.pBVHRoot[0].aabbMin;
+				trackedMesh.boundsMax = mesh.pBVHRoot[0].aabbMax;
+			}
+			return trackedMesh;
+		};
+
+	// Shadows and mirror reflections of a moved mesh can be bounded, indirect bounces can reach any pixel.
+	// Checkerboard frames reconstruct from the whole previous frame. Only meshes move, lights and other geometry are static.
+	m_IsIncrementalFrame = m_DirtyRegionsEnabled
+		&& m_AreDirtyRegionsTracked
+		&& !m_GlobalIlluminationEnabled
+		&& m_IntegratorMode != IntegratorMode::PathTracer
+		&& !( m_CheckerboardEnabled && !m_AccumulationEnabled )
+		&& pScene == m_pTrackedScene
+		&& camera.cameraToWorld == m_TrackedCameraToWorld
+		&& camera.fovCoefficient == m_TrackedFovCoefficient
+		&& meshes.size( ) == m_TrackedMeshes.size( );
+
+	m_AreDirtyRegionsTracked = m_DirtyRegionsEnabled;
+	m_pTrackedScene = pScene;
+	m_TrackedCameraToWorld = camera.cameraToWorld;
+	m_TrackedFovCoefficient = camera.fovCoefficient;
+
+	if ( !m_IsIncrementalFrame )
+	{
+		MarkAllTilesDirty( );
+		m_TrackedMeshes.clear( );
+		std::transform( meshes.begin( ), meshes.end( ), std::back_inserter( m_TrackedMeshes ), trackMesh );
+		return;
+	}
+
+	for ( Tile& tile : m_Tiles )
+	{
+		tile.isDirty = false;
+	}
+
+	bool hasChanged{ false };
+	for ( size_t meshIdx{}; meshIdx < meshes.size( ); ++meshIdx )
+	{
+		TrackedMesh& trackedMesh{ m_TrackedMeshes[meshIdx] };
+		if ( meshes[meshIdx].revision == trackedMesh.revision )
+		{
+			continue;
+		}
+
+		// The mesh left its old bounds and now covers its new ones
+		MarkDirtyBounds( pScene, camera, trackedMesh );
+		trackedMesh = trackMesh( meshes[meshIdx] );
+		MarkDirtyBounds( pScene, camera, trackedMesh );
+		hasChanged = true;
+	}
+
+	if ( hasChanged )
+	{
+		for ( Tile& tile : m_Tiles )
+		{
+			tile.isDirty = tile.isDirty || tile.hasReflection;
+		}
+	}
+	m_DirtyTileCount = uint32_t( std::count_if( m_Tiles.begin( ), m_Tiles.end( ), []( const Tile& tile ) { return tile.isDirty; } ) );
+}
+
+void dae::Renderer::MarkDirtyBounds( const Scene* pScene, const Camera& camera, const TrackedMesh& mesh )
+{
+	if ( !mesh.hasBounds )
+	{
+		MarkAllTilesDirty( );
+		return;
+	}
+
+	const Vector3 cameraRight{ camera.cameraToWorld.GetAxisX( ) };
+	const Vector3 cameraUp{ camera.cameraToWorld.GetAxisY( ) };
+	const Vector3 cameraForward{ camera.cameraToWorld.GetAxisZ( ) };
+	const auto toCameraSpace = [&cameraRight, &cameraUp, &cameraForward]( const Vector3& vector )
+		{
+			return Vector3{ Vector3::Dot( vector, cameraRight ), Vector3::Dot( vector, cameraUp ), Vector3::Dot( vector, cameraForward ) };
+		};
+
+	// Soft shadow rays start SHADOW_RADIUS off the surface and aim up to SHADOW_RADIUS beside the light.
+	// Growing the box by both keeps its extrusion from the light center conservative.
+	const float margin{ m_ShadowsMode == ShadowMode::Soft ? 2.f * SHADOW_RADIUS : .001f };
+	const Vector3 boundsMin{ mesh.boundsMin - Vector3{ margin, margin, margin } };
+	const Vector3 boundsMax{ mesh.boundsMax + Vector3{ margin, margin, margin } };
+
+	// Bounds on the image plane, in camera space x/z and y/z
+	float minX{ FLT_MAX };
+	float minY{ FLT_MAX };
+	float maxX{ -FLT_MAX };
+	float maxY{ -FLT_MAX };
+	const auto addPoint = [&minX, &minY, &maxX, &maxY]( float x, float y )
+		{
+			minX = std::min( minX, x );
+			minY = std::min( minY, y );
+			maxX = std::max( maxX, x );
+			maxY = std::max( maxY, y );
+		};
+
+	for ( int cornerIdx{}; cornerIdx < 8; ++cornerIdx )
+	{
+		const Vector3 corner{
+			cornerIdx & 1 ? boundsMax.x : boundsMin.x,
+			cornerIdx & 2 ? boundsMax.y : boundsMin.y,
+			cornerIdx & 4 ? boundsMax.z : boundsMin.z };
+		const Vector3 cornerView{ toCameraSpace( corner - camera.origin ) };
+
+		// A box reaching behind the camera has no bounded projection
+		if ( cornerView.z <= 0.f )
+		{
+			MarkAllTilesDirty( );
+			return;
+		}
+		addPoint( cornerView.x / cornerView.z, cornerView.y / cornerView.z );
+
+		if ( m_ShadowsMode == ShadowMode::None )
+		{
+			continue;
+		}
+
+		// The shadow volume is the box pushed away from every light, each corner extrudes along a ray
+		for ( const Light& light : pScene->GetLights( ) )
+		{
+			Vector3 shadowDirection{ corner - light.origin };
+			if ( light.type == LightType::Directional )
+			{
+				// Soft shadow samples of directional lights are not bounded by a radius
+				if ( m_ShadowsMode == ShadowMode::Soft )
+				{
+					MarkAllTilesDirty( );
+					return;
+				}
+				shadowDirection = -light.direction;
+			}
+
+			const Vector3 directionView{ toCameraSpace( shadowDirection ) };
+			if ( directionView.z > 0.f )
+			{
+				// The projected ray ends in its vanishing point
+				addPoint( directionView.x / directionView.z, directionView.y / directionView.z );
+			}
+			else
+			{
+				// The ray leaves the view, its projection runs off the screen in the direction it starts in
+				const float screenDirectionX{ directionView.x * cornerView.z - cornerView.x * directionView.z };
+				const float screenDirectionY{ directionView.y * cornerView.z - cornerView.y * directionView.z };
+				maxX = screenDirectionX > 0.f ? FLT_MAX : maxX;
+				minX = screenDirectionX < 0.f ? -FLT_MAX : minX;
+				maxY = screenDirectionY > 0.f ? FLT_MAX : maxY;
+				minY = screenDirectionY < 0.f ? -FLT_MAX : minY;
+			}
+		}
+	}
+
+	// Image plane to pixels (the inverse of ScreenToNDC), grown by a pixel for rounding
+	const float xScale{ .5f * m_RenderWidth / ( m_AspectRatio * camera.fovCoefficient ) };
+	const float yScale{ .5f * m_RenderHeight / camera.fovCoefficient };
+	const float left{ minX * xScale + .5f * m_RenderWidth - 1.5f };
+	const float right{ maxX * xScale + .5f * m_RenderWidth + .5f };
+	const float top{ -maxY * yScale + .5f * m_RenderHeight - 1.5f };
+	const float bottom{ -minY * yScale + .5f * m_RenderHeight + .5f };
+	if ( right < 0.f || bottom < 0.f || left >= m_RenderWidth || top >= m_RenderHeight )
+	{
+		return;
+	}
+
+	const int tilesPerRow{ ( m_RenderWidth + TILE_SIZE - 1 ) / TILE_SIZE };
+	const int firstColumn{ int( std::max( left, 0.f ) ) / TILE_SIZE };
+	const int lastColumn{ int( std::min( right, float( m_RenderWidth - 1 ) ) ) / TILE_SIZE };
+	const int firstRow{ int( std::max( top, 0.f ) ) / TILE_SIZE };
+	const int lastRow{ int( std::min( bottom, float( m_RenderHeight - 1 ) ) ) / TILE_SIZE };
+	for ( int row{ firstRow }; row <= lastRow; ++row )
+	{
+		for ( int column{ firstColumn }; column <= lastColumn; ++column )
+		{
+			m_Tiles[column + row * tilesPerRow].isDirty = true;
+		}
+	}
+}
+
+void dae::Renderer::UpdatePrimaryHits( const Scene* pScene, const Camera& camera )
+{
+	const uint64_t sceneRevision{ pScene->GetRevision( ) };
+	const bool isSameView{ pScene == m_pPrimaryHitScene
+		&& camera.cameraToWorld == m_PrimaryHitCameraToWorld
+		&& camera.fovCoefficient == m_PrimaryHitFovCoefficient };
+	if ( isSameView && sceneRevision == m_PrimaryHitSceneRevision )
+	{
+		return;
+	}
+
+	// Moved meshes can only change the primary hits inside their dirty tiles
+	const bool isGeometryChangeBounded{ isSameView && m_IsIncrementalFrame };
+	for ( Tile& tile : m_Tiles )
+	{
+		tile.hasPrimaryHits = tile.hasPrimaryHits && isGeometryChangeBounded && !tile.isDirty;
+	}
+
+	m_pPrimaryHitScene = pScene;
+	m_PrimaryHitSceneRevision = sceneRevision;
+	m_PrimaryHitCameraToWorld = camera.cameraToWorld;
+	m_PrimaryHitFovCoefficient = camera.fovCoefficient;
+}
+
+void dae::Renderer::MarkAllTilesDirty( )
+{
+	for ( Tile& tile : m_Tiles )
+	{
+		tile.isDirty = true;
+	}
+	m_DirtyTileCount = uint32_t( m_Tiles.size( ) );
+}
+
 void dae::Renderer::SetLightingMode( LightingMode mode )
 {
 	m_LightingMode = mode;
+	ResetAccumulation( );
 	switch ( m_LightingMode )
 	{
 	case LightingMode::ObservedArea:
@@ -294,6 +1620,21 @@ void dae::LogSceneInfo( const Scene* pScene, const Renderer* pRenderer, float dF
 	logInfo.lightingMode = static_cast<int>( pRenderer->m_LightingMode );
 	logInfo.shadowMode = static_cast<int>( pRenderer->m_ShadowsMode );
 	logInfo.gi = pRenderer->m_GlobalIlluminationEnabled;
+	logInfo.accumulation = pRenderer->m_AccumulationEnabled;
+	logInfo.accumulatedFrames = pRenderer->m_AccumulatedFrames;
+	logInfo.adaptive = pRenderer->m_AccumulationEnabled && pRenderer->m_AdaptiveSamplingEnabled;
+	logInfo.convergedTiles = pRenderer->m_ConvergedTileCount;
+	logInfo.totalTiles = uint32_t( pRenderer->m_Tiles.size( ) );
+	logInfo.checkerboard = pRenderer->m_CheckerboardEnabled && !pRenderer->m_AccumulationEnabled;
+	logInfo.dirtyRegions = pRenderer->m_DirtyRegionsEnabled;
+	logInfo.dirtyTiles = pRenderer->m_DirtyTileCount;
+	logInfo.denoiser = pRenderer->IsDenoising( );
+	logInfo.renderWidth = pRenderer->m_RenderWidth;
+	logInfo.renderHeight = pRenderer->m_RenderHeight;
+	logInfo.shadowSamples = pRenderer->GetSetSampleCount( pRenderer->m_ShadowSamples );
+	logInfo.indirectSamples = pRenderer->GetSetSampleCount( pRenderer->m_IndirectSamples );
+	logInfo.sampleSequence = static_cast<int>( pRenderer->m_SampleSequence );
+	logInfo.integrator = static_cast<int>( pRenderer->m_IntegratorMode );
 	logInfo.dFPS = dFPS;
 	LogSceneInfo( logInfo );
 }
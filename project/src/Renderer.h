@@ -2,7 +2,10 @@
 
 #include <cstdint>
 #include <functional>
+#include <mutex>
+#include <vector>
 
+#include "Sampler.h"
 #include "Scene.h"
 #include "logging.hpp"
 
@@ -11,7 +14,9 @@ struct SDL_Surface;
 
 namespace dae
 {
+	class Denoiser;
 	class Scene;
+	class Material;
 
 	enum class LightingMode
 	{
@@ -28,10 +33,30 @@ namespace dae
 		None
 	};
 
+	enum class IntegratorMode
+	{
+		Whitted,   // Direct light, mirror reflections and the optional global illumination gather
+		PathTracer // Unidirectional paths with next event estimation, converges while accumulating
+	};
+
+	struct RayCounters
+	{
+		uint64_t primary{};
+		uint64_t shadow{};
+		uint64_t secondary{};
+
+		uint64_t Total( ) const
+		{
+			return primary + shadow + secondary;
+		}
+	};
+
 	class Renderer final
 	{
 	public:
 		Renderer( SDL_Window* pWindow );
+		// Headless renderer, draws into an offscreen surface instead of a window
+		Renderer( int width, int height );
 		~Renderer( );
 
 		Renderer( const Renderer& ) = delete;
@@ -39,36 +64,194 @@ namespace dae
 		Renderer& operator=( const Renderer& ) = delete;
 		Renderer& operator=( Renderer&& ) noexcept = delete;
 
-		void Render( Scene* pScene ) const;
-		void RenderPixel( Scene* pScene, uint32_t pixelIdx, const Camera& camera ) const;
-		void ProcessRay( Scene* pScene, Ray ray, ColorRGB& finalColor, int bounce = 0 ) const;
+		// Traces a frame into the back buffer, then hands it over to Present. Never waits on the display.
+		void Render( Scene* pScene );
+		// Copies the last finished frame to the window. Returns false when no new frame was ready.
+		bool Present( );
+		// Traces one sample of the pixel, clamped to displayable range. The sample index picks its random numbers.
+		ColorRGB RenderPixel( Scene* pScene, int px, int py, const Camera& camera, uint32_t sampleIdx = 0, HitRecord* pPrimaryHit = nullptr ) const;
+		// Traces one sample per pixel of a part of the frame into pPixels, row by row, in the buffer's pixel format.
+		// Leaves the frame buffers and every per frame cache alone, the distributed workers render through this.
+		void RenderRegion( Scene* pScene, int left, int top, int right, int bottom, uint32_t* pPixels ) const;
+		// Throughput is how much the ray's color can still count in the pixel, it decides which secondary rays are traced.
+		// pHitRecord receives the closest hit of this ray, if requested
+		void ProcessRay( Scene* pScene, Ray ray, ColorRGB& finalColor, Sampler& sampler, int bounce = 0, float throughput = 1.f, HitRecord* pHitRecord = nullptr, LightingSplit* pSplit = nullptr ) const;
 		bool SaveBufferToImage( ) const;
+		// Copies the last finished frame into pPixels, width * height tightly packed rows in the buffer's pixel format
+		void CopyFrame( uint32_t* pPixels );
 
 		void ToggleShadows( );
 		void ToggleLightingMode( );
 		void ToggleGlobalIllumination( );
+		void ToggleAccumulation( );
+		void ToggleAdaptiveSampling( );
+		void ToggleCheckerboard( );
+		void ToggleDirtyRegions( );
+		void ToggleDenoiser( );
+		void ToggleSampleSequence( );
+		void ToggleIntegratorMode( );
+
+		void SetLightingMode( LightingMode mode );
+		void SetShadowMode( ShadowMode mode );
+		// Sequence the soft shadow and global illumination sample points are drawn from
+		void SetSampleSequence( SampleSequence sequence );
+		// The path tracer ignores the lighting mode and global illumination toggles, it always gathers every bounce
+		void SetIntegratorMode( IntegratorMode mode );
+		void SetGlobalIllumination( bool enabled );
+		void SetAccumulation( bool enabled );
+		// Only used while accumulating: noisy tiles get more samples per frame, converged tiles stop sampling
+		void SetAdaptiveSampling( bool enabled );
+		// Traces half of the pixels per frame in a checkerboard and reprojects the previous frame for the other half.
+		// Ignored while accumulating.
+		void SetCheckerboard( bool enabled );
+		// While the camera is static, only traces the tiles that moved meshes, their shadows or reflections can reach.
+		// Ignored with checkerboard rendering, global illumination and the path tracer.
+		void SetDirtyRegions( bool enabled );
+		// Edge-aware à-trous filter over the traced frame, guided by the G-buffer. Ignored while accumulating.
+		void SetDenoiser( bool enabled );
+		// Internal resolution as a fraction of the output, scaled frames are upscaled edge aware
+		void SetRenderScale( float scale );
+		// Runtime soft shadow and global illumination sample counts, SHADOW_SAMPLES and INDIRECT_SAMPLING by default
+		void SetShadowSamples( int samples );
+		void SetIndirectSamples( int samples );
+		// Drops the accumulated samples
+		void ResetAccumulation( );
+		// Drops everything kept from earlier frames, primary hits included.
+		// Needed after swapping scenes, a new scene can reuse the address of the old one.
+		void ResetSceneCaches( );
+		// Frame the random numbers of the next render are keyed on, it counts up by one every render.
+		// Offline renders set it to the animation frame, so a frame comes out the same whoever renders it.
+		void SetFrameIndex( uint32_t frameIdx ) { m_FrameIdx = frameIdx; }
 
 		LightingMode GetLightingMode( );
+		bool IsAccumulating( ) const { return m_AccumulationEnabled; }
+		uint32_t GetAccumulatedFrames( ) const { return m_AccumulatedFrames; }
+		int GetWidth( ) const { return m_Width; }
+		int GetHeight( ) const { return m_Height; }
+		int GetRenderWidth( ) const { return m_RenderWidth; }
+		int GetRenderHeight( ) const { return m_RenderHeight; }
+		int GetShadowSamples( ) const { return m_ShadowSamples; }
+		int GetIndirectSamples( ) const { return m_IndirectSamples; }
+
+		// Rays traced by every render thread since the last reset
+		static RayCounters GetRayCounters( );
+		static void ResetRayCounters( );
 
 		friend void LogSceneInfo( const Scene* pScene, const Renderer* pRenderer, float dFPS );
 		
 	private:
+		// Screen region traced as one task. Sample count and convergence are tracked per tile while accumulating.
+		struct Tile
+		{
+			int left{};
+			int top{};
+			int right{};
+			int bottom{};
+
+			uint32_t sampleCount{};
+			// Samples per pixel the tile traces this frame
+			uint32_t frameSampleCount{ 1 };
+			// Root mean square over its pixels of the standard deviation of their luminance
+			float deviation{};
+			bool isConverged{ false };
+
+			// Whether a moved mesh can change its pixels this frame
+			bool isDirty{ true };
+			// Whether a primary ray hit a reflective surface, its pixels may show any change in the scene
+			bool hasReflection{ false };
+			// Whether the G-buffer holds the primary hits of its pixels for the current camera and geometry
+			bool hasPrimaryHits{ false };
+		};
+
+		// Bounds of a mesh the last time its tiles were marked
+		struct TrackedMesh
+		{
+			uint32_t revision{};
+			bool hasBounds{ false };
+			Vector3 boundsMin{};
+			Vector3 boundsMax{};
+		};
+
 		LightingMode m_LightingMode{ LightingMode::Combined };
 		std::function<void( ShadeInfo& shadeInfo, const LightingInfo&, ColorRGB& )> m_LightingFn{};
 		ShadowMode m_ShadowsMode{ ShadowMode::Hard };
 		bool m_GlobalIlluminationEnabled{ false };
+		uint32_t m_FrameIdx{};
+		SampleSequence m_SampleSequence{ SampleSequence::SobolOwen };
+		IntegratorMode m_IntegratorMode{ IntegratorMode::Whitted };
+
+		// Progressive accumulation: running sum of every sample traced since the view last changed
+		bool m_AccumulationEnabled{ false };
+		bool m_AdaptiveSamplingEnabled{ false };
+		ColorRGB* m_pAccumulationBuffer{};
+		float* m_pLuminanceSquares{};
+		uint32_t m_AccumulatedFrames{};
+		uint32_t m_ConvergedTileCount{};
+		const Scene* m_pAccumulatedScene{};
+		uint64_t m_AccumulatedSceneRevision{};
+		Matrix m_AccumulatedCameraToWorld{};
+		float m_AccumulatedFovCoefficient{};
+
+		// Checkerboard rendering: colors and primary hit depths of this frame, colors and camera of the previous one
+		bool m_CheckerboardEnabled{ false };
+		bool m_IsCheckerboardFrame{ false };
+		bool m_IsCheckerboardHistoryValid{ false };
+		int m_CheckerboardParity{};
+		const Scene* m_pCheckerboardScene{};
+		ColorRGB* m_pFrameColors{};
+		ColorRGB* m_pHistoryColors{};
+		float* m_pFrameDepths{};
+		Matrix m_HistoryCameraToWorld{};
+		float m_HistoryFovCoefficient{};
+
+		// Dirty regions: changes are tracked per mesh against the previous frame, with the same camera
+		bool m_DirtyRegionsEnabled{ false };
+		bool m_IsIncrementalFrame{ false };
+		bool m_AreDirtyRegionsTracked{ false };
+		uint32_t m_DirtyTileCount{};
+		const Scene* m_pTrackedScene{};
+		Matrix m_TrackedCameraToWorld{};
+		float m_TrackedFovCoefficient{};
+		std::vector<TrackedMesh> m_TrackedMeshes{};
+
+		// G-buffer: primary hits only depend on the camera and the geometry, lighting and shadow changes shade from it
+		HitRecord* m_pPrimaryHits{};
+		const Scene* m_pPrimaryHitScene{};
+		uint64_t m_PrimaryHitSceneRevision{};
+		Matrix m_PrimaryHitCameraToWorld{};
+		float m_PrimaryHitFovCoefficient{};
 
 		SDL_Window* m_pWindow{};
 
 		SDL_Surface* m_pBuffer{};
+		bool m_OwnsBuffer{ false };
+
+		// Render traces into one back buffer while the other keeps the last finished frame for Present
+		uint32_t* m_pBackBuffers[2]{};
 		uint32_t* m_pBufferPixels{};
+		int m_RenderBufferIdx{};
+		bool m_HasNewFrame{ false };
+		std::mutex m_SwapMutex{};
 
-		uint32_t* m_pPixelIndices{};
+		std::vector<Tile> m_Tiles{};
 
 		int m_Width{};
 		int m_Height{};
 		float m_AspectRatio;
 
+		// Internal resolution and quality, lowered by the frame governor
+		int m_RenderWidth{};
+		int m_RenderHeight{};
+		int m_ShadowSamples{};
+		int m_IndirectSamples{};
+
+		// Full precision colors at the render resolution, for the passes after tracing (denoise, upscale)
+		ColorRGB* m_pRenderColors{};
+		Denoiser* m_pDenoiser{};
+		// How the primary hit of every pixel was lit, only filled in while denoising
+		LightingSplit* m_pLightingSplits{};
+		bool m_DenoiserEnabled{ false };
+
 		//void ExecuteRenderCycle( dae::Scene* pScene ) const;
 		inline void ScreenToNDC( float& x, float& y, int px, int py, float fov ) const;
 
@@ -77,10 +260,52 @@ namespace dae
 		void BRDFLightingFn( ShadeInfo& shadeInfo, const LightingInfo& info, ColorRGB& finalColor ) const;
 		void CombinedLightingFn( ShadeInfo& shadeInfo, const LightingInfo& info, ColorRGB& finalColor ) const;
 
-		void RenderSoftShadows( Scene* pScene, LightingInfo& info ) const;
+		Ray GetPrimaryRay( int px, int py, const Camera& camera ) const;
+		// Accumulated samples of a pixel share one frame key, so they continue a single sequence
+		Sampler CreateSampler( int px, int py, uint32_t sampleIdx ) const;
+		// Lights the hit of the ray, and traces its reflection and global illumination bounces.
+		// pSplit, when given, receives how the hit was lit.
+		void ShadeHit( Scene* pScene, const Ray& ray, const HitRecord& hitRecord, ColorRGB& finalColor, Sampler& sampler, int bounce, float throughput, LightingSplit* pSplit = nullptr ) const;
+		// Direct light of one light, scaled by lightWeight, with its shadow and the reflection it triggers
+		void ShadeLight( Scene* pScene, LightingInfo& info, const Light& light, float lightWeight, ColorRGB& finalColor, Sampler& sampler, int bounce, float throughput ) const;
+		// Radiance the path starting at the hit of ray carries back along it, one light sample and one BRDF sample per bounce
+		ColorRGB TracePath( Scene* pScene, Ray ray, HitRecord hitRecord, Sampler& sampler ) const;
+		// Direct light at the hit of a path toward view, with the same light selection as ShadeHit
+		ColorRGB SampleDirectLight( Scene* pScene, const HitRecord& hitRecord, const Vector3& view, Material* pMaterial, Sampler& sampler ) const;
+		// Culls secondary rays below MIN_RAY_CONTRIBUTION, and plays Russian roulette on the deeper bounces.
+		// A surviving ray's color is scaled by the compensation.
+		bool ShouldTrace( float throughput, int bounce, Sampler& sampler, float& compensation ) const;
+		// Points in one set of the sample sequence: Sobol points are only stratified in power of two blocks,
+		// so with them the count is rounded up to the next power of two
+		int GetSetSampleCount( int samples ) const;
+		// Shades the pixel from its G-buffer hit, the primary ray is only traced when isHitCached is false
+		ColorRGB RenderGBufferPixel( Scene* pScene, int px, int py, const Camera& camera, uint32_t sampleIdx, bool isHitCached ) const;
+		void RenderSoftShadows( Scene* pScene, LightingInfo& info, Sampler& sampler ) const;
+		void DistributeTileSamples( );
+		void RenderTile( Scene* pScene, Tile& tile, const Camera& camera ) const;
+		float EstimateTileDeviation( const Tile& tile ) const;
+		// Fills the pixels a checkerboard frame skipped
+		void ReconstructTile( const Tile& tile, const Camera& camera ) const;
+		bool IsScaled( ) const { return m_RenderWidth != m_Width || m_RenderHeight != m_Height; }
+		// Accumulated frames converge on their own, they are never denoised
+		bool IsDenoising( ) const { return m_DenoiserEnabled && !m_AccumulationEnabled; }
+		bool IsPostProcessed( ) const { return IsScaled( ) || IsDenoising( ); }
+		// Writes to the back buffer, or to the render colors when the frame is post processed
+		void WritePixel( ColorRGB& finalColor, uint32_t pixelIdx ) const;
+		// Writes post processed colors to the back buffer, upscaled edge aware when rendering below the output resolution
+		void Resolve( const ColorRGB* pColors ) const;
 
 		void UpdateBuffer( dae::ColorRGB& finalColor, uint32_t* const pBufferHead ) const;
+		// Marks the tiles that changed meshes can affect, or every tile when the view itself changed
+		void UpdateDirtyTiles( const Scene* pScene, const Camera& camera );
+		// Marks the tiles covered by the box and, with shadows on, by the shadow it casts from every light
+		void MarkDirtyBounds( const Scene* pScene, const Camera& camera, const TrackedMesh& mesh );
+		void MarkAllTilesDirty( );
+		// Drops the cached primary hits the camera or geometry changes made stale
+		void UpdatePrimaryHits( const Scene* pScene, const Camera& camera );
+		// Restarts accumulation when the camera, the scene or its geometry changed since the last frame
+		void UpdateAccumulation( const Scene* pScene, const Camera& camera );
 
-		void SetLightingMode( LightingMode mode );
+		void InitializePixels( );
 	};
 }
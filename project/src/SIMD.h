@@ -0,0 +1,299 @@
+#pragma once
+
+//External includes
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#include <emmintrin.h>
+#define MATH_USE_SSE
+#endif
+#if defined( MATH_USE_SSE ) && defined( __AVX__ )
+#include <immintrin.h>
+#define MATH_USE_AVX
+#endif
+
+//Standard includes
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+//Project includes
+#include "ColorRGB.h"
+#include "Vector3.h"
+#include "Vector4.h"
+
+namespace dae
+{
+	/**
+	 * \brief Four floats worked on at once: one SSE register, or a plain array where SSE is not available.
+	 * Loads and stores are unaligned, so it reads straight from Vector4s, pixel rows or any float array.
+	 * Comparisons give a mask with all bits set in the lanes where they hold, for Select and GetMask.
+	 */
+	struct alignas( 16 ) Float4
+	{
+#ifdef MATH_USE_SSE
+		__m128 value;
+
+		Float4( ) = default;
+		Float4( __m128 _value ) : value{ _value } {}
+		explicit Float4( float splat ) : value{ _mm_set1_ps( splat ) } {}
+		Float4( float x, float y, float z, float w ) : value{ _mm_setr_ps( x, y, z, w ) } {}
+
+		static Float4 Load( const float* pValues ) { return _mm_loadu_ps( pValues ); }
+		void Store( float* pValues ) const { _mm_storeu_ps( pValues, value ); }
+
+		friend Float4 operator+( Float4 lhs, Float4 rhs ) { return _mm_add_ps( lhs.value, rhs.value ); }
+		friend Float4 operator-( Float4 lhs, Float4 rhs ) { return _mm_sub_ps( lhs.value, rhs.value ); }
+		friend Float4 operator*( Float4 lhs, Float4 rhs ) { return _mm_mul_ps( lhs.value, rhs.value ); }
+		friend Float4 operator/( Float4 lhs, Float4 rhs ) { return _mm_div_ps( lhs.value, rhs.value ); }
+		friend Float4 operator<( Float4 lhs, Float4 rhs ) { return _mm_cmplt_ps( lhs.value, rhs.value ); }
+		friend Float4 operator>( Float4 lhs, Float4 rhs ) { return _mm_cmpgt_ps( lhs.value, rhs.value ); }
+		friend Float4 operator&( Float4 lhs, Float4 rhs ) { return _mm_and_ps( lhs.value, rhs.value ); }
+		friend Float4 operator|( Float4 lhs, Float4 rhs ) { return _mm_or_ps( lhs.value, rhs.value ); }
+
+		static Float4 Min( Float4 lhs, Float4 rhs ) { return _mm_min_ps( lhs.value, rhs.value ); }
+		static Float4 Max( Float4 lhs, Float4 rhs ) { return _mm_max_ps( lhs.value, rhs.value ); }
+		static Float4 Sqrt( Float4 v ) { return _mm_sqrt_ps( v.value ); }
+		// Lanes of ifTrue where the mask is set, of ifFalse elsewhere
+		static Float4 Select( Float4 mask, Float4 ifTrue, Float4 ifFalse )
+		{
+			return _mm_or_ps( _mm_and_ps( mask.value, ifTrue.value ), _mm_andnot_ps( mask.value, ifFalse.value ) );
+		}
+		// One bit per lane, lane 0 in the lowest bit
+		int GetMask( ) const { return _mm_movemask_ps( value ); }
+#else
+		float values[4];
+
+		Float4( ) = default;
+		explicit Float4( float splat ) : values{ splat, splat, splat, splat } {}
+		Float4( float x, float y, float z, float w ) : values{ x, y, z, w } {}
+
+		static Float4 Load( const float* pValues ) { return { pValues[0], pValues[1], pValues[2], pValues[3] }; }
+		void Store( float* pValues ) const { std::copy_n( values, 4, pValues ); }
+
+		friend Float4 operator+( Float4 lhs, Float4 rhs ) { return Apply( lhs, rhs, []( float a, float b ) { return a + b; } ); }
+		friend Float4 operator-( Float4 lhs, Float4 rhs ) { return Apply( lhs, rhs, []( float a, float b ) { return a - b; } ); }
+		friend Float4 operator*( Float4 lhs, Float4 rhs ) { return Apply( lhs, rhs, []( float a, float b ) { return a * b; } ); }
+		friend Float4 operator/( Float4 lhs, Float4 rhs ) { return Apply( lhs, rhs, []( float a, float b ) { return a / b; } ); }
+		friend Float4 operator<( Float4 lhs, Float4 rhs ) { return Apply( lhs, rhs, []( float a, float b ) { return ToMask( a < b ); } ); }
+		friend Float4 operator>( Float4 lhs, Float4 rhs ) { return Apply( lhs, rhs, []( float a, float b ) { return ToMask( a > b ); } ); }
+		friend Float4 operator&( Float4 lhs, Float4 rhs )
+		{
+			return Apply( lhs, rhs, []( float a, float b ) { return std::bit_cast<float>( std::bit_cast<uint32_t>( a ) & std::bit_cast<uint32_t>( b ) ); } );
+		}
+		friend Float4 operator|( Float4 lhs, Float4 rhs )
+		{
+			return Apply( lhs, rhs, []( float a, float b ) { return std::bit_cast<float>( std::bit_cast<uint32_t>( a ) | std::bit_cast<uint32_t>( b ) ); } );
+		}
+
+		static Float4 Min( Float4 lhs, Float4 rhs ) { return Apply( lhs, rhs, []( float a, float b ) { return b < a ? b : a; } ); }
+		static Float4 Max( Float4 lhs, Float4 rhs ) { return Apply( lhs, rhs, []( float a, float b ) { return a < b ? b : a; } ); }
+		static Float4 Sqrt( Float4 v ) { return { std::sqrt( v.values[0] ), std::sqrt( v.values[1] ), std::sqrt( v.values[2] ), std::sqrt( v.values[3] ) }; }
+		// Lanes of ifTrue where the mask is set, of ifFalse elsewhere
+		static Float4 Select( Float4 mask, Float4 ifTrue, Float4 ifFalse )
+		{
+			Float4 result;
+			for ( int lane{}; lane < 4; ++lane )
+			{
+				result.values[lane] = std::bit_cast<uint32_t>( mask.values[lane] ) ? ifTrue.values[lane] : ifFalse.values[lane];
+			}
+			return result;
+		}
+		// One bit per lane, lane 0 in the lowest bit
+		int GetMask( ) const
+		{
+			int mask{};
+			for ( int lane{}; lane < 4; ++lane )
+			{
+				mask |= int( std::bit_cast<uint32_t>( values[lane] ) >> 31 ) << lane;
+			}
+			return mask;
+		}
+
+	private:
+		template<typename Fn>
+		static Float4 Apply( Float4 lhs, Float4 rhs, Fn&& fn )
+		{
+			return { fn( lhs.values[0], rhs.values[0] ), fn( lhs.values[1], rhs.values[1] ), fn( lhs.values[2], rhs.values[2] ), fn( lhs.values[3], rhs.values[3] ) };
+		}
+		static float ToMask( bool condition ) { return std::bit_cast<float>( condition ? ~0u : 0u ); }
+
+	public:
+#endif
+		Float4( const Vector4& v ) : Float4{ v.x, v.y, v.z, v.w } {}
+		// Vectors get a w of 0 and points a w of 1, like Vector3::ToVector4 and ToPoint4
+		static Float4 FromVector( const Vector3& v ) { return { v.x, v.y, v.z, 0.f }; }
+		static Float4 FromPoint( const Vector3& p ) { return { p.x, p.y, p.z, 1.f }; }
+		static Float4 FromColor( const ColorRGB& c ) { return { c.r, c.g, c.b, 0.f }; }
+
+		float operator[]( int index ) const
+		{
+			alignas( 16 ) float lanes[4];
+			Store( lanes );
+			return lanes[index];
+		}
+
+		Vector3 ToVector3( ) const
+		{
+			alignas( 16 ) float lanes[4];
+			Store( lanes );
+			return { lanes[0], lanes[1], lanes[2] };
+		}
+		Vector4 ToVector4( ) const
+		{
+			alignas( 16 ) float lanes[4];
+			Store( lanes );
+			return { lanes[0], lanes[1], lanes[2], lanes[3] };
+		}
+		ColorRGB ToColor( ) const
+		{
+			alignas( 16 ) float lanes[4];
+			Store( lanes );
+			return { lanes[0], lanes[1], lanes[2] };
+		}
+
+		Float4& operator+=( Float4 v ) { return *this = *this + v; }
+		Float4& operator-=( Float4 v ) { return *this = *this - v; }
+		Float4& operator*=( Float4 v ) { return *this = *this * v; }
+		Float4& operator/=( Float4 v ) { return *this = *this / v; }
+
+		static Float4 MultiplyAdd( Float4 lhs, Float4 rhs, Float4 addend ) { return lhs * rhs + addend; }
+		static float Dot( Float4 lhs, Float4 rhs )
+		{
+			alignas( 16 ) float lanes[4];
+			( lhs * rhs ).Store( lanes );
+			return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+		}
+	};
+
+	/**
+	 * \brief Eight floats worked on at once: one AVX register, or two Float4 halves where AVX is not enabled.
+	 * Meant for structure of arrays batch kernels, one lane per ray, triangle or light.
+	 */
+	struct alignas( 32 ) Float8
+	{
+#ifdef MATH_USE_AVX
+		__m256 value;
+
+		Float8( ) = default;
+		Float8( __m256 _value ) : value{ _value } {}
+		explicit Float8( float splat ) : value{ _mm256_set1_ps( splat ) } {}
+
+		static Float8 Load( const float* pValues ) { return _mm256_loadu_ps( pValues ); }
+		void Store( float* pValues ) const { _mm256_storeu_ps( pValues, value ); }
+
+		friend Float8 operator+( Float8 lhs, Float8 rhs ) { return _mm256_add_ps( lhs.value, rhs.value ); }
+		friend Float8 operator-( Float8 lhs, Float8 rhs ) { return _mm256_sub_ps( lhs.value, rhs.value ); }
+		friend Float8 operator*( Float8 lhs, Float8 rhs ) { return _mm256_mul_ps( lhs.value, rhs.value ); }
+		friend Float8 operator/( Float8 lhs, Float8 rhs ) { return _mm256_div_ps( lhs.value, rhs.value ); }
+		friend Float8 operator<( Float8 lhs, Float8 rhs ) { return _mm256_cmp_ps( lhs.value, rhs.value, _CMP_LT_OQ ); }
+		friend Float8 operator>( Float8 lhs, Float8 rhs ) { return _mm256_cmp_ps( lhs.value, rhs.value, _CMP_GT_OQ ); }
+		friend Float8 operator&( Float8 lhs, Float8 rhs ) { return _mm256_and_ps( lhs.value, rhs.value ); }
+		friend Float8 operator|( Float8 lhs, Float8 rhs ) { return _mm256_or_ps( lhs.value, rhs.value ); }
+
+		static Float8 Min( Float8 lhs, Float8 rhs ) { return _mm256_min_ps( lhs.value, rhs.value ); }
+		static Float8 Max( Float8 lhs, Float8 rhs ) { return _mm256_max_ps( lhs.value, rhs.value ); }
+		static Float8 Sqrt( Float8 v ) { return _mm256_sqrt_ps( v.value ); }
+		static Float8 Select( Float8 mask, Float8 ifTrue, Float8 ifFalse ) { return _mm256_blendv_ps( ifFalse.value, ifTrue.value, mask.value ); }
+		int GetMask( ) const { return _mm256_movemask_ps( value ); }
+#else
+		Float4 low;
+		Float4 high;
+
+		Float8( ) = default;
+		Float8( Float4 _low, Float4 _high ) : low{ _low }, high{ _high } {}
+		explicit Float8( float splat ) : low{ splat }, high{ splat } {}
+
+		static Float8 Load( const float* pValues ) { return { Float4::Load( pValues ), Float4::Load( pValues + 4 ) }; }
+		void Store( float* pValues ) const
+		{
+			low.Store( pValues );
+			high.Store( pValues + 4 );
+		}
+
+		friend Float8 operator+( const Float8& lhs, const Float8& rhs ) { return { lhs.low + rhs.low, lhs.high + rhs.high }; }
+		friend Float8 operator-( const Float8& lhs, const Float8& rhs ) { return { lhs.low - rhs.low, lhs.high - rhs.high }; }
+		friend Float8 operator*( const Float8& lhs, const Float8& rhs ) { return { lhs.low * rhs.low, lhs.high * rhs.high }; }
+		friend Float8 operator/( const Float8& lhs, const Float8& rhs ) { return { lhs.low / rhs.low, lhs.high / rhs.high }; }
+		friend Float8 operator<( const Float8& lhs, const Float8& rhs ) { return { lhs.low < rhs.low, lhs.high < rhs.high }; }
+		friend Float8 operator>( const Float8& lhs, const Float8& rhs ) { return { lhs.low > rhs.low, lhs.high > rhs.high }; }
+		friend Float8 operator&( const Float8& lhs, const Float8& rhs ) { return { lhs.low & rhs.low, lhs.high & rhs.high }; }
+		friend Float8 operator|( const Float8& lhs, const Float8& rhs ) { return { lhs.low | rhs.low, lhs.high | rhs.high }; }
+
+		static Float8 Min( const Float8& lhs, const Float8& rhs ) { return { Float4::Min( lhs.low, rhs.low ), Float4::Min( lhs.high, rhs.high ) }; }
+		static Float8 Max( const Float8& lhs, const Float8& rhs ) { return { Float4::Max( lhs.low, rhs.low ), Float4::Max( lhs.high, rhs.high ) }; }
+		static Float8 Sqrt( const Float8& v ) { return { Float4::Sqrt( v.low ), Float4::Sqrt( v.high ) }; }
+		static Float8 Select( const Float8& mask, const Float8& ifTrue, const Float8& ifFalse )
+		{
+			return { Float4::Select( mask.low, ifTrue.low, ifFalse.low ), Float4::Select( mask.high, ifTrue.high, ifFalse.high ) };
+		}
+		int GetMask( ) const { return low.GetMask( ) | high.GetMask( ) << 4; }
+#endif
+
+		float operator[]( int index ) const
+		{
+			alignas( 32 ) float lanes[8];
+			Store( lanes );
+			return lanes[index];
+		}
+
+		Float8& operator+=( const Float8& v ) { return *this = *this + v; }
+		Float8& operator-=( const Float8& v ) { return *this = *this - v; }
+		Float8& operator*=( const Float8& v ) { return *this = *this * v; }
+
+		static Float8 MultiplyAdd( const Float8& lhs, const Float8& rhs, const Float8& addend ) { return lhs * rhs + addend; }
+	};
+
+	/**
+	 * \brief Eight Vector3s as structure of arrays, every component in a Float8 of its own.
+	 * Batch kernels test one ray against eight primitives, or eight rays against one, with the same math as Vector3.
+	 */
+	struct Vector3x8
+	{
+		Float8 x;
+		Float8 y;
+		Float8 z;
+
+		Vector3x8( ) = default;
+		Vector3x8( const Float8& _x, const Float8& _y, const Float8& _z ) : x{ _x }, y{ _y }, z{ _z } {}
+		// The same vector in every lane
+		explicit Vector3x8( const Vector3& v ) : x{ v.x }, y{ v.y }, z{ v.z } {}
+
+		// Transposes eight consecutive Vector3s
+		static Vector3x8 Load( const Vector3* pVectors )
+		{
+			alignas( 32 ) float components[3][8];
+			for ( int lane{}; lane < 8; ++lane )
+			{
+				components[0][lane] = pVectors[lane].x;
+				components[1][lane] = pVectors[lane].y;
+				components[2][lane] = pVectors[lane].z;
+			}
+			return { Float8::Load( components[0] ), Float8::Load( components[1] ), Float8::Load( components[2] ) };
+		}
+
+		Vector3 Get( int lane ) const { return { x[lane], y[lane], z[lane] }; }
+
+		friend Vector3x8 operator+( const Vector3x8& lhs, const Vector3x8& rhs ) { return { lhs.x + rhs.x, lhs.y + rhs.y, lhs.z + rhs.z }; }
+		friend Vector3x8 operator-( const Vector3x8& lhs, const Vector3x8& rhs ) { return { lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z }; }
+		friend Vector3x8 operator*( const Vector3x8& v, const Float8& scale ) { return { v.x * scale, v.y * scale, v.z * scale }; }
+
+		static Float8 Dot( const Vector3x8& v1, const Vector3x8& v2 )
+		{
+			return Float8::MultiplyAdd( v1.x, v2.x, Float8::MultiplyAdd( v1.y, v2.y, v1.z * v2.z ) );
+		}
+
+		static Vector3x8 Cross( const Vector3x8& v1, const Vector3x8& v2 )
+		{
+			return { v1.y * v2.z - v1.z * v2.y, v1.z * v2.x - v1.x * v2.z, v1.x * v2.y - v1.y * v2.x };
+		}
+
+		static Vector3x8 Min( const Vector3x8& v1, const Vector3x8& v2 )
+		{
+			return { Float8::Min( v1.x, v2.x ), Float8::Min( v1.y, v2.y ), Float8::Min( v1.z, v2.z ) };
+		}
+
+		static Vector3x8 Max( const Vector3x8& v1, const Vector3x8& v2 )
+		{
+			return { Float8::Max( v1.x, v2.x ), Float8::Max( v1.y, v2.y ), Float8::Max( v1.z, v2.z ) };
+		}
+	};
+}
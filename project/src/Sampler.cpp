@@ -0,0 +1,256 @@
+#include "Sampler.h"
+
+//Standard includes
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+//Project includes
+#include "mangled_random.hpp"
+
+// Width and height of the tiled blue noise mask, a power of two
+#define BLUE_NOISE_SIZE 64
+// Standard deviation of the void-and-cluster energy filter, in pixels
+#define BLUE_NOISE_SIGMA 1.5f
+
+using namespace dae;
+
+namespace
+{
+	// 1 / plastic number and 1 / plastic number², the R2 steps in 0.32 fixed point
+	constexpr uint32_t R2_STEP_U{ 3242174889u };
+	constexpr uint32_t R2_STEP_V{ 2447445414u };
+	// 1 / golden ratio in 0.32 fixed point, steps the blue noise from frame to frame
+	constexpr uint32_t GOLDEN_STEP{ 2654435769u };
+
+	inline float ToUnitFloat( uint32_t value )
+	{
+		// The top 24 bits, a float can't hold more below 1
+		return float( value >> 8 ) * ( 1.f / 16777216.f );
+	}
+
+	inline uint32_t ReverseBits( uint32_t value )
+	{
+		value = ( value << 16 ) | ( value >> 16 );
+		value = ( ( value & 0x00ff00ffu ) << 8 ) | ( ( value & 0xff00ff00u ) >> 8 );
+		value = ( ( value & 0x0f0f0f0fu ) << 4 ) | ( ( value & 0xf0f0f0f0u ) >> 4 );
+		value = ( ( value & 0x33333333u ) << 2 ) | ( ( value & 0xccccccccu ) >> 2 );
+		value = ( ( value & 0x55555555u ) << 1 ) | ( ( value & 0xaaaaaaaau ) >> 1 );
+		return value;
+	}
+
+	// Hash based Owen scrambling (Burley 2020): every bit is flipped depending on the bits above it only,
+	// which keeps the stratification of the sequence intact
+	inline uint32_t OwenScramble( uint32_t value, uint32_t seed )
+	{
+		value = ReverseBits( value );
+		value += seed;
+		value ^= value * 0x6c50b47cu;
+		value ^= value * 0xb82f1e52u;
+		value ^= value * 0xc7afe638u;
+		value ^= value * 0x8d22f6e6u;
+		return ReverseBits( value );
+	}
+
+	// First two Sobol dimensions, the van der Corput sequence and the one generated by x + 1
+	inline uint32_t Sobol0( uint32_t index )
+	{
+		return ReverseBits( index );
+	}
+
+	inline uint32_t Sobol1( uint32_t index )
+	{
+		uint32_t result{};
+		for ( uint32_t direction{ 1u << 31 }; index; index >>= 1, direction ^= direction >> 1 )
+		{
+			if ( index & 1 )
+			{
+				result ^= direction;
+			}
+		}
+		return result;
+	}
+
+	// Void-and-cluster (Ulichney 1993): every pixel gets a rank, and thresholding the ranks at any level gives
+	// points that are spread as evenly as possible. Built once, on first use, in well under a tenth of a second.
+	std::vector<float> CreateBlueNoise( )
+	{
+		constexpr int size{ BLUE_NOISE_SIZE };
+		constexpr int pixelCount{ size * size };
+		constexpr int radius{ int( BLUE_NOISE_SIGMA * 4.f ) + 1 };
+		constexpr int kernelWidth{ 2 * radius + 1 };
+
+		float kernel[kernelWidth * kernelWidth]{};
+		for ( int dy{ -radius }; dy <= radius; ++dy )
+		{
+			for ( int dx{ -radius }; dx <= radius; ++dx )
+			{
+				kernel[( dy + radius ) * kernelWidth + dx + radius] = std::exp( -float( dx * dx + dy * dy ) / ( 2.f * BLUE_NOISE_SIGMA * BLUE_NOISE_SIGMA ) );
+			}
+		}
+
+		std::vector<float> energy( pixelCount );
+		std::vector<bool> isSet( pixelCount );
+		// The mask tiles, the energy wraps around the edges
+		const auto splat = [&]( int pixelIdx, float sign )
+			{
+				const int x{ pixelIdx % size };
+				const int y{ pixelIdx / size };
+				for ( int dy{ -radius }; dy <= radius; ++dy )
+				{
+					for ( int dx{ -radius }; dx <= radius; ++dx )
+					{
+						const int target{ ( ( y + dy ) & ( size - 1 ) ) * size + ( ( x + dx ) & ( size - 1 ) ) };
+						energy[target] += sign * kernel[( dy + radius ) * kernelWidth + dx + radius];
+					}
+				}
+			};
+		const auto findTightestCluster = [&]( )
+			{
+				int best{ -1 };
+				for ( int pixelIdx{}; pixelIdx < pixelCount; ++pixelIdx )
+				{
+					if ( isSet[pixelIdx] && ( best < 0 || energy[pixelIdx] > energy[best] ) )
+					{
+						best = pixelIdx;
+					}
+				}
+				return best;
+			};
+		// Also the tightest cluster of the unset pixels, their energy is the total minus this one
+		const auto findLargestVoid = [&]( )
+			{
+				int best{ -1 };
+				for ( int pixelIdx{}; pixelIdx < pixelCount; ++pixelIdx )
+				{
+					if ( !isSet[pixelIdx] && ( best < 0 || energy[pixelIdx] < energy[best] ) )
+					{
+						best = pixelIdx;
+					}
+				}
+				return best;
+			};
+
+		// Random initial pattern, relaxed by moving the tightest cluster to the largest void until it settles
+		const int initialCount{ pixelCount / 10 };
+		for ( int pointIdx{}, attempt{}; pointIdx < initialCount; ++attempt )
+		{
+			const int pixelIdx{ int( Get1dNoiseUint( attempt ) % pixelCount ) };
+			if ( !isSet[pixelIdx] )
+			{
+				isSet[pixelIdx] = true;
+				splat( pixelIdx, 1.f );
+				++pointIdx;
+			}
+		}
+		for ( int iteration{}; iteration < pixelCount; ++iteration )
+		{
+			const int cluster{ findTightestCluster( ) };
+			isSet[cluster] = false;
+			splat( cluster, -1.f );
+			const int largestVoid{ findLargestVoid( ) };
+			isSet[largestVoid] = true;
+			splat( largestVoid, 1.f );
+			if ( largestVoid == cluster )
+			{
+				break;
+			}
+		}
+
+		std::vector<int> ranks( pixelCount );
+		const std::vector<float> prototypeEnergy{ energy };
+		const std::vector<bool> prototype{ isSet };
+		// Take the initial points away cluster by cluster, they rank below it
+		for ( int rank{ initialCount - 1 }; rank >= 0; --rank )
+		{
+			const int cluster{ findTightestCluster( ) };
+			isSet[cluster] = false;
+			splat( cluster, -1.f );
+			ranks[cluster] = rank;
+		}
+		// Then fill the voids from the initial points up
+		energy = prototypeEnergy;
+		isSet = prototype;
+		for ( int rank{ initialCount }; rank < pixelCount; ++rank )
+		{
+			const int largestVoid{ findLargestVoid( ) };
+			isSet[largestVoid] = true;
+			splat( largestVoid, 1.f );
+			ranks[largestVoid] = rank;
+		}
+
+		std::vector<float> mask( pixelCount );
+		for ( int pixelIdx{}; pixelIdx < pixelCount; ++pixelIdx )
+		{
+			mask[pixelIdx] = ( float( ranks[pixelIdx] ) + .5f ) / float( pixelCount );
+		}
+		return mask;
+	}
+
+	// Blue noise value in 0.32 fixed point
+	inline uint32_t GetBlueNoise( int x, int y )
+	{
+		static const std::vector<float> s_Mask{ CreateBlueNoise( ) };
+		const float value{ s_Mask[( y & ( BLUE_NOISE_SIZE - 1 ) ) * BLUE_NOISE_SIZE + ( x & ( BLUE_NOISE_SIZE - 1 ) )] };
+		return uint32_t( double( value ) * 4294967296.0 );
+	}
+}
+
+Sampler::Sampler( SampleSequence sequence, int px, int py, uint32_t pixelIdx, uint32_t frameIdx, uint32_t sampleIdx ) :
+	m_Sequence{ sequence },
+	m_PixelX{ px },
+	m_PixelY{ py },
+	m_PixelSeed{ Get1dNoiseUint( int( pixelIdx ), frameIdx ) },
+	m_FrameIdx{ frameIdx },
+	m_SampleIdx{ sampleIdx },
+	m_Random{ pixelIdx, frameIdx, sampleIdx }
+{
+}
+
+void Sampler::Get2D( uint32_t dimension, uint32_t pointIdx, uint32_t pointCount, float& u, float& v ) const
+{
+	// Accumulated samples carry on with the points after the ones the previous sample used
+	const uint32_t index{ m_SampleIdx * pointCount + pointIdx };
+
+	switch ( m_Sequence )
+	{
+	case SampleSequence::WhiteNoise:
+	{
+		const uint32_t randomDimension{ ( dimension << 16 | pointIdx ) * 2 };
+		u = m_Random.Get( randomDimension );
+		v = m_Random.Get( randomDimension + 1 );
+		// The noise functions reach 1 inclusive
+		u = std::min( u, .99999994f );
+		v = std::min( v, .99999994f );
+		break;
+	}
+	case SampleSequence::SobolOwen:
+	{
+		const uint32_t seed{ Get1dNoiseUint( int( dimension ), m_PixelSeed ) };
+		// Shuffling the index with the same scramble keeps every power of two prefix a full stratification
+		const uint32_t shuffledIndex{ OwenScramble( index, seed ) };
+		u = ToUnitFloat( OwenScramble( Sobol0( shuffledIndex ), Get1dNoiseUint( 0, seed ) ) );
+		v = ToUnitFloat( OwenScramble( Sobol1( shuffledIndex ), Get1dNoiseUint( 1, seed ) ) );
+		break;
+	}
+	case SampleSequence::R2:
+	{
+		const uint32_t seed{ Get1dNoiseUint( int( dimension ), m_PixelSeed ) };
+		u = ToUnitFloat( Get1dNoiseUint( 0, seed ) + index * R2_STEP_U );
+		v = ToUnitFloat( Get1dNoiseUint( 1, seed ) + index * R2_STEP_V );
+		break;
+	}
+	case SampleSequence::BlueNoise:
+	{
+		// Every dimension pair reads another part of the mask, every frame moves the values along the golden ratio
+		const int offsetX{ int( ( dimension * R2_STEP_U ) >> 26 ) };
+		const int offsetY{ int( ( dimension * R2_STEP_V ) >> 26 ) };
+		const uint32_t frameOffset{ m_FrameIdx * GOLDEN_STEP };
+		const uint32_t rotationU{ GetBlueNoise( m_PixelX + offsetX, m_PixelY + offsetY ) + frameOffset };
+		const uint32_t rotationV{ GetBlueNoise( m_PixelX + offsetX + BLUE_NOISE_SIZE / 2, m_PixelY + offsetY + BLUE_NOISE_SIZE / 2 ) + frameOffset };
+		u = ToUnitFloat( rotationU + index * R2_STEP_U );
+		v = ToUnitFloat( rotationV + index * R2_STEP_V );
+		break;
+	}
+	}
+}
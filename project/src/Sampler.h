@@ -0,0 +1,54 @@
+#pragma once
+
+//Standard includes
+#include <cstdint>
+
+//Project includes
+#include "RandomStream.h"
+
+namespace dae
+{
+	enum class SampleSequence
+	{
+		WhiteNoise, // Independent hashed values
+		SobolOwen,	// Sobol points, Owen scrambled per pixel
+		R2,			// Additive recurrence on the plastic number, rotated per pixel
+		BlueNoise	// R2 rotated by a tiled blue noise mask, the error between pixels is high frequency
+	};
+
+	/**
+	 * \brief Hands out the 2D sample points of one pixel sample. A set of points drawn for the same dimension pair,
+	 * like the shadow rays toward one light, is stratified together, and the next accumulated sample of the pixel
+	 * continues the same sequence where the previous one stopped. Every pixel scrambles or rotates the sequence
+	 * differently, so neighbouring pixels don't repeat each other's pattern. Like RandomStream everything is a
+	 * function of the pixel, frame, sample and dimension, nothing depends on the thread or the tracing order.
+	 */
+	class Sampler final
+	{
+	public:
+		Sampler( SampleSequence sequence, int px, int py, uint32_t pixelIdx, uint32_t frameIdx, uint32_t sampleIdx );
+
+		// Reserves the dimension pair of the next set of points
+		uint32_t NextDimension( ) { return m_Dimension++; }
+		// Point pointIdx of a set of pointCount points, in [0, 1)
+		void Get2D( uint32_t dimension, uint32_t pointIdx, uint32_t pointCount, float& u, float& v ) const;
+		// Single value in [0, 1) from a dimension pair of its own
+		float Next1D( )
+		{
+			float u, v;
+			Get2D( NextDimension( ), 0, 1, u, v );
+			return u;
+		}
+
+	private:
+		SampleSequence m_Sequence;
+		int m_PixelX;
+		int m_PixelY;
+		// Scrambles the sequence of this pixel, the same for all of its accumulated samples
+		uint32_t m_PixelSeed;
+		uint32_t m_FrameIdx;
+		uint32_t m_SampleIdx;
+		uint32_t m_Dimension{};
+		RandomStream m_Random;
+	};
+}
@@ -1,6 +1,10 @@
 #include "Scene.h"
 #include "Utils.h"
 #include "Material.h"
+#include "Timer.h"
+
+// Radiance below which a point light stops counting, half a step of the 8 bit buffer
+#define LIGHT_INFLUENCE_CUTOFF ( .5f / 255.f )
 
 namespace dae
 {
@@ -99,6 +103,42 @@ namespace dae
 		return false;
 	}
 
+	const LightTree& Scene::GetLightTree( ) const
+	{
+		UpdateLightStructures( );
+		return m_LightTree;
+	}
+
+	const LightGrid& Scene::GetLightGrid( ) const
+	{
+		UpdateLightStructures( );
+		return m_LightGrid;
+	}
+
+	void Scene::UpdateLightStructures( ) const
+	{
+		if ( !m_AreLightStructuresValid.load( std::memory_order_acquire ) )
+		{
+			std::lock_guard lock{ m_LightStructuresMutex };
+			if ( !m_AreLightStructuresValid.load( std::memory_order_relaxed ) )
+			{
+				m_LightTree.Build( m_Lights );
+				m_LightGrid.Build( m_Lights );
+				m_AreLightStructuresValid.store( true, std::memory_order_release );
+			}
+		}
+	}
+
+	uint64_t Scene::GetRevision( ) const
+	{
+		uint64_t revision{};
+		for ( const auto& triangleMesh : m_TriangleMeshGeometries )
+		{
+			revision += triangleMesh.revision;
+		}
+		return revision;
+	}
+
 	// Changed and updates the Camera's Field of View
 	void Scene::ChangeCameraFov( float fov )
 	{
@@ -139,19 +179,21 @@ namespace dae
 		return &m_TriangleMeshGeometries.back( );
 	}
 
-	Light* Scene::AddPointLight( const Vector3& origin, float intensity, const ColorRGB& color )
+	const Light* Scene::AddPointLight( const Vector3& origin, float intensity, const ColorRGB& color )
 	{
 		Light l;
 		l.origin = origin;
 		l.intensity = intensity;
 		l.color = color;
 		l.type = LightType::Point;
+		l.range = LightUtils::GetInfluenceRadius( l, LIGHT_INFLUENCE_CUTOFF );
 
 		m_Lights.emplace_back( l );
+		m_AreLightStructuresValid = false;
 		return &m_Lights.back( );
 	}
 
-	Light* Scene::AddDirectionalLight( const Vector3& direction, float intensity, const ColorRGB& color )
+	const Light* Scene::AddDirectionalLight( const Vector3& direction, float intensity, const ColorRGB& color )
 	{
 		Light l;
 		l.direction = direction;
@@ -160,6 +202,7 @@ namespace dae
 		l.type = LightType::Directional;
 
 		m_Lights.emplace_back( l );
+		m_AreLightStructuresValid = false;
 		return &m_Lights.back( );
 	}
 
@@ -174,6 +217,7 @@ namespace dae
 #pragma region SCENE W1
 	void Scene_W1::Initialize( )
 	{
+		sceneName = "Week 1 Scene";
 		//default: Material id0 >> SolidColor Material (RED)
 		constexpr unsigned char matId_Solid_Red = 0;
 		const unsigned char matId_Solid_Blue = AddMaterial( new Material_SolidColor{ colors::Blue } );
@@ -198,6 +242,7 @@ namespace dae
 #pragma region SCENE W2
 	void Scene_W2::Initialize( )
 	{
+		sceneName = "Week 2 Scene";
 		m_Camera.origin = { 0.f, 3.f, -9.f };
 		ChangeCameraFov( 45.f );
 
@@ -232,6 +277,7 @@ namespace dae
 #pragma region SCENE W3
 	void Scene_W3_TestScene::Initialize( )
 	{
+		sceneName = "Week 3 Test Scene";
 		m_Camera.origin = { 0.f, 1.f, -5.f };
 		ChangeCameraFov( 45.f );
 
@@ -253,6 +299,7 @@ namespace dae
 
 	void Scene_W3::Initialize( )
 	{
+		sceneName = "Week 3 Scene";
 		m_Camera.origin = { 0.f, 3.f, -9.f };
 		ChangeCameraFov( 45.f );
 
@@ -297,6 +344,7 @@ namespace dae
 #pragma region SCENE W4
 	void Scene_W4_TestScene::Initialize( )
 	{
+		sceneName = "Week 4 Test Scene";
 		m_Camera.origin = { 0.f, 1.f, -5.f };
 		//m_Camera.origin = { 0.f, 1.f, 4.f };
 		//m_Camera.totalYaw = PI;
@@ -1,10 +1,14 @@
 #pragma once
+#include <atomic>
+#include <mutex>
 #include <string>
 #include <vector>
 
 #include "Maths.h"
 #include "DataTypes.h"
 #include "Camera.h"
+#include "LightGrid.h"
+#include "LightTree.h"
 #include <SDL.h>
 
 namespace dae
@@ -29,9 +33,9 @@ namespace dae
 		Scene& operator=(Scene&&) noexcept = delete;
 
 		virtual void Initialize() = 0;
-		virtual void Update(dae::Timer* pTimer)
+		// The camera moves by the input the main thread hands over, see Camera::ApplyInput
+		virtual void Update(dae::Timer*)
 		{
-			m_Camera.Update(pTimer);
 		}
 
 		Camera& GetCamera() { return m_Camera; }
@@ -42,9 +46,17 @@ namespace dae
 
 		const std::vector<Plane>& GetPlaneGeometries() const { return m_PlaneGeometries; }
 		const std::vector<Sphere>& GetSphereGeometries() const { return m_SphereGeometries; }
+		const std::vector<TriangleMesh>& GetTriangleMeshGeometries() const { return m_TriangleMeshGeometries; }
 		const std::vector<Light>& GetLights() const { return m_Lights; }
+		// Hierarchy over the point lights, built on first use after the lights changed
+		const LightTree& GetLightTree( ) const;
+		// Point lights by the region they can reach, built together with the light tree
+		const LightGrid& GetLightGrid( ) const;
 		const std::vector<Material*>& GetMaterials() const { return m_Materials; }
 
+		// Changes whenever the geometry moves, static scenes keep the same revision
+		uint64_t GetRevision( ) const;
+
 		const std::string& GetSceneName( ) const
 		{
 			return sceneName;
@@ -59,6 +71,12 @@ namespace dae
 		std::vector<Light> m_Lights{};
 		std::vector<Material*> m_Materials{};
 
+		// Render threads can ask for them at the same time, the first one builds them
+		mutable LightTree m_LightTree{};
+		mutable LightGrid m_LightGrid{};
+		mutable std::mutex m_LightStructuresMutex{};
+		mutable std::atomic<bool> m_AreLightStructuresValid{ false };
+
 		//// Temp (Individual Triangle Testing)
 		//std::vector<Triangle> m_Triangles{};
 
@@ -68,9 +86,14 @@ namespace dae
 		Plane* AddPlane(const Vector3& origin, const Vector3& normal, unsigned char materialIndex = 0);
 		TriangleMesh* AddTriangleMesh(TriangleCullMode cullMode, unsigned char materialIndex = 0);
 
-		Light* AddPointLight(const Vector3& origin, float intensity, const ColorRGB& color);
-		Light* AddDirectionalLight(const Vector3& direction, float intensity, const ColorRGB& color);
+		// Lights must be added before rendering starts, the acceleration structures are rebuilt on first use.
+		// They come back const: the light tree, the light grid and every light's range are derived from them
+		const Light* AddPointLight(const Vector3& origin, float intensity, const ColorRGB& color);
+		const Light* AddDirectionalLight(const Vector3& direction, float intensity, const ColorRGB& color);
 		unsigned char AddMaterial(Material* pMaterial);
+
+	private:
+		void UpdateLightStructures( ) const;
 	};
 
 	//+++++++++++++++++++++++++++++++++++++++++
@@ -0,0 +1,122 @@
+#include "SceneLoader.h"
+
+//Project includes
+#include "logging.hpp"
+#include "Profiler.h"
+#include "Scene.h"
+
+using namespace dae;
+
+SceneLoader::SceneLoader( ) :
+	m_Thread{ &SceneLoader::Run, this }
+{
+}
+
+SceneLoader::~SceneLoader( )
+{
+	{
+		std::lock_guard lock{ m_Mutex };
+		m_IsRunning = false;
+	}
+	m_WakeUp.notify_one( );
+	m_Thread.join( );
+
+	// Whatever the thread did not get to
+	for ( Scene* pScene : m_ScenesToDelete )
+	{
+		delete pScene;
+	}
+	delete m_pLoadedScene;
+}
+
+void SceneLoader::Load( const std::function<Scene*( )>& fnFactory )
+{
+	{
+		std::lock_guard lock{ m_Mutex };
+		m_fnPendingFactory = fnFactory;
+		++m_RequestId;
+	}
+	m_WakeUp.notify_one( );
+}
+
+Scene* SceneLoader::TakeLoadedScene( )
+{
+	std::lock_guard lock{ m_Mutex };
+
+	Scene* pScene{ m_pLoadedScene };
+	m_pLoadedScene = nullptr;
+	return pScene;
+}
+
+void SceneLoader::Release( Scene* pScene )
+{
+	if ( !pScene )
+	{
+		return;
+	}
+
+	{
+		std::lock_guard lock{ m_Mutex };
+		m_ScenesToDelete.push_back( pScene );
+	}
+	m_WakeUp.notify_one( );
+}
+
+void SceneLoader::Run( )
+{
+	Profiler::SetThreadName( "SceneLoader" );
+
+	std::unique_lock lock{ m_Mutex };
+	while ( true )
+	{
+		m_WakeUp.wait( lock, [this]( )
+			{
+				return !m_IsRunning || m_fnPendingFactory || !m_ScenesToDelete.empty( );
+			} );
+		if ( !m_IsRunning )
+		{
+			break;
+		}
+
+		// Teardown first, it frees memory for the next build
+		std::vector<Scene*> scenesToDelete{};
+		scenesToDelete.swap( m_ScenesToDelete );
+		const std::function<Scene*( )> fnFactory{ std::move( m_fnPendingFactory ) };
+		m_fnPendingFactory = nullptr;
+		const uint32_t requestId{ m_RequestId };
+
+		lock.unlock( );
+		for ( Scene* pScene : scenesToDelete )
+		{
+			PROFILE_SCOPE( "SceneLoader::Delete" );
+			delete pScene;
+		}
+
+		Scene* pNewScene{};
+		if ( fnFactory )
+		{
+			PROFILE_SCOPE( "SceneLoader::Load" );
+			LogSceneInfo( "Initializing ..." );
+			pNewScene = fnFactory( );
+			pNewScene->Initialize( );
+		}
+		lock.lock( );
+
+		if ( pNewScene )
+		{
+			// Superseded while building, or never picked up: only the newest scene is handed out
+			if ( requestId != m_RequestId )
+			{
+				m_ScenesToDelete.push_back( pNewScene );
+			}
+			else
+			{
+				if ( m_pLoadedScene )
+				{
+					m_ScenesToDelete.push_back( m_pLoadedScene );
+				}
+				m_pLoadedScene = pNewScene;
+			}
+		}
+	}
+}
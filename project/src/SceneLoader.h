@@ -0,0 +1,53 @@
+#pragma once
+
+//Standard includes
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dae
+{
+	class Scene;
+
+	/**
+	 * \brief Builds and destroys scenes on a background thread. Construction, Initialize (OBJ parsing,
+	 * first BVH build) and teardown never run on the render thread; it only picks up the finished scene
+	 * between two frames through TakeLoadedScene.
+	 */
+	class SceneLoader final
+	{
+	public:
+		SceneLoader( );
+		~SceneLoader( );
+
+		SceneLoader( const SceneLoader& ) = delete;
+		SceneLoader( SceneLoader&& ) noexcept = delete;
+		SceneLoader& operator=( const SceneLoader& ) = delete;
+		SceneLoader& operator=( SceneLoader&& ) noexcept = delete;
+
+		// Starts building a scene. A newer request replaces one that did not finish yet.
+		void Load( const std::function<Scene*( )>& fnFactory );
+		// The finished scene, handed out once. nullptr while nothing new is ready.
+		Scene* TakeLoadedScene( );
+		// Deletes the scene on the loader thread
+		void Release( Scene* pScene );
+
+	private:
+		std::mutex m_Mutex{};
+		std::condition_variable m_WakeUp{};
+
+		std::function<Scene*( )> m_fnPendingFactory{};
+		uint32_t m_RequestId{};
+		Scene* m_pLoadedScene{};
+		std::vector<Scene*> m_ScenesToDelete{};
+		bool m_IsRunning{ true };
+
+		// Declared last so everything it touches exists before it starts
+		std::thread m_Thread{};
+
+		void Run( );
+	};
+}
@@ -0,0 +1,155 @@
+#include "SequenceRenderer.h"
+
+//External includes
+#include "SDL.h"
+
+//Standard includes
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include <utility>
+
+//Project includes
+#include "Profiler.h"
+#include "Renderer.h"
+#include "Scene.h"
+#include "Timer.h"
+
+// How many frames the pipelines may run ahead of the output, per pipeline
+#define FRAMES_AHEAD_PER_PIPELINE 2
+
+using namespace dae;
+
+SequenceRenderer::SequenceRenderer( std::vector<std::function<Scene*( )>> sceneFactories, const SequenceSettings& settings ) :
+	m_SceneFactories{ std::move( sceneFactories ) },
+	m_Settings{ settings }
+{
+}
+
+bool SequenceRenderer::Run( const FrameSink& fnSink )
+{
+	if ( m_Settings.sceneIdx >= m_SceneFactories.size( ) || m_Settings.firstFrame > m_Settings.lastFrame )
+	{
+		std::cout << ">> Nothing to render, check the scene index and the frame range" << std::endl;
+		return false;
+	}
+
+	m_NextFrame = m_Settings.firstFrame;
+	m_NextOutputFrame = m_Settings.firstFrame;
+	m_IsStopped = false;
+	m_FinishedFrames.clear( );
+
+	const uint32_t frameCount{ m_Settings.lastFrame - m_Settings.firstFrame + 1 };
+	const uint32_t pipelineCount{ std::clamp( m_Settings.framesInFlight, 1u, frameCount ) };
+	std::cout << "**SEQUENCE STARTED** frames " << m_Settings.firstFrame << " to " << m_Settings.lastFrame
+		<< ", " << pipelineCount << " in flight\n";
+	const uint64_t start{ SDL_GetPerformanceCounter( ) };
+
+	std::vector<std::thread> pipelines{};
+	pipelines.reserve( pipelineCount );
+	for ( uint32_t pipelineIdx{}; pipelineIdx < pipelineCount; ++pipelineIdx )
+	{
+		pipelines.emplace_back( &SequenceRenderer::RunPipeline, this );
+	}
+
+	bool isComplete{ true };
+	for ( uint32_t frame{ m_Settings.firstFrame }; frame <= m_Settings.lastFrame; ++frame )
+	{
+		std::vector<uint32_t> pixels{};
+		{
+			std::unique_lock lock{ m_Mutex };
+			m_Changed.wait( lock, [this, frame]( ) { return m_FinishedFrames.contains( frame ); } );
+			pixels = std::move( m_FinishedFrames[frame] );
+			m_FinishedFrames.erase( frame );
+		}
+
+		// Outside the lock, the pipelines keep rendering while the sink writes
+		isComplete = fnSink( frame, pixels.data( ) );
+		{
+			std::lock_guard lock{ m_Mutex };
+			m_NextOutputFrame = frame + 1;
+			m_IsStopped = !isComplete;
+		}
+		m_Changed.notify_all( );
+
+		if ( !isComplete )
+		{
+			std::cout << ">> Output failed at frame " << frame << ", stopping" << std::endl;
+			break;
+		}
+	}
+
+	for ( std::thread& pipeline : pipelines )
+	{
+		pipeline.join( );
+	}
+
+	if ( isComplete )
+	{
+		const double seconds{ double( SDL_GetPerformanceCounter( ) - start ) / double( SDL_GetPerformanceFrequency( ) ) };
+		std::cout << "**SEQUENCE FINISHED** " << frameCount << " frames in " << seconds << "s ("
+			<< double( frameCount ) / seconds << " frames/s)" << std::endl;
+	}
+	return isComplete;
+}
+
+void SequenceRenderer::RunPipeline( )
+{
+	Profiler::SetThreadName( "Sequence" );
+
+	Scene* pScene{ m_SceneFactories[m_Settings.sceneIdx]( ) };
+	pScene->Initialize( );
+
+	const auto pRenderer = new Renderer( m_Settings.width, m_Settings.height );
+	pRenderer->SetLightingMode( LightingMode( m_Settings.lightingMode ) );
+	pRenderer->SetShadowMode( ShadowMode( m_Settings.shadowMode ) );
+	pRenderer->SetGlobalIllumination( m_Settings.globalIllumination );
+
+	Timer timer{};
+	timer.SetFixedTimeStep( 1.f / m_Settings.frameRate );
+	timer.Reset( );
+
+	uint32_t frame{};
+	while ( AcquireFrame( frame ) )
+	{
+		PROFILE_SCOPE( "SequenceRenderer::Frame" );
+
+		timer.SetFixedFrame( frame );
+		pScene->Update( &timer );
+		pRenderer->SetFrameIndex( frame );
+		pRenderer->Render( pScene );
+
+		std::vector<uint32_t> pixels( size_t( m_Settings.width ) * m_Settings.height );
+		pRenderer->CopyFrame( pixels.data( ) );
+		SubmitFrame( frame, std::move( pixels ) );
+	}
+
+	delete pRenderer;
+	delete pScene;
+}
+
+bool SequenceRenderer::AcquireFrame( uint32_t& frame )
+{
+	std::unique_lock lock{ m_Mutex };
+	const uint32_t maxFramesAhead{ std::max( m_Settings.framesInFlight, 1u ) * FRAMES_AHEAD_PER_PIPELINE };
+	m_Changed.wait( lock, [this, maxFramesAhead]( )
+		{
+			return m_IsStopped || m_NextFrame > m_Settings.lastFrame || m_NextFrame < m_NextOutputFrame + maxFramesAhead;
+		} );
+
+	if ( m_IsStopped || m_NextFrame > m_Settings.lastFrame )
+	{
+		return false;
+	}
+	frame = m_NextFrame++;
+	return true;
+}
+
+void SequenceRenderer::SubmitFrame( uint32_t frame, std::vector<uint32_t>&& pixels )
+{
+	{
+		std::lock_guard lock{ m_Mutex };
+		m_FinishedFrames[frame] = std::move( pixels );
+	}
+	m_Changed.notify_all( );
+}
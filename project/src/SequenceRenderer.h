@@ -0,0 +1,75 @@
+#pragma once
+
+//Standard includes
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace dae
+{
+	class Scene;
+
+	struct SequenceSettings
+	{
+		uint32_t sceneIdx{};
+		int width{ 1280 };
+		int height{ 720 };
+		// Inclusive range, frame n shows the scene at n / frameRate seconds
+		uint32_t firstFrame{};
+		uint32_t lastFrame{ 59 };
+		float frameRate{ 30.f };
+		// Frames rendered at the same time, each by its own scene and renderer
+		uint32_t framesInFlight{ 2 };
+		int lightingMode{ 3 };
+		int shadowMode{};
+		bool globalIllumination{ false };
+		std::string outputPath{ "sequence_" };
+		// Streams YUV4MPEG2 to this file or pipe instead of writing images, "-" is stdout
+		std::string videoPath{};
+	};
+
+	/**
+	 * \brief Renders a range of animation frames offline. Every frame is evaluated at a fixed timestamp, so the
+	 * result does not depend on how long frames take. Several pipelines, each with its own copy of the scene
+	 * and its own headless renderer, trace different frames at once, which keeps every core busy even where
+	 * one frame alone does not split up well. Finished frames are handed to the output strictly in order.
+	 */
+	class SequenceRenderer final
+	{
+	public:
+		// Receives every frame in order, width * height ARGB8888 pixels. Returning false stops the sequence.
+		using FrameSink = std::function<bool( uint32_t frame, const uint32_t* pPixels )>;
+
+		SequenceRenderer( std::vector<std::function<Scene*( )>> sceneFactories, const SequenceSettings& settings );
+		~SequenceRenderer( ) = default;
+
+		SequenceRenderer( const SequenceRenderer& ) = delete;
+		SequenceRenderer( SequenceRenderer&& ) noexcept = delete;
+		SequenceRenderer& operator=( const SequenceRenderer& ) = delete;
+		SequenceRenderer& operator=( SequenceRenderer&& ) noexcept = delete;
+
+		// Renders the range, calling fnSink on this thread. Returns false if the sink stopped it.
+		bool Run( const FrameSink& fnSink );
+
+	private:
+		std::vector<std::function<Scene*( )>> m_SceneFactories;
+		SequenceSettings m_Settings;
+
+		std::mutex m_Mutex{};
+		std::condition_variable m_Changed{};
+		uint32_t m_NextFrame{};
+		uint32_t m_NextOutputFrame{};
+		bool m_IsStopped{ false };
+		// Finished frames waiting for the ones before them
+		std::map<uint32_t, std::vector<uint32_t>> m_FinishedFrames{};
+
+		void RunPipeline( );
+		// Next frame to render. Blocks while the pipelines are too far ahead of the output, false once the range is done.
+		bool AcquireFrame( uint32_t& frame );
+		void SubmitFrame( uint32_t frame, std::vector<uint32_t>&& pixels );
+	};
+}
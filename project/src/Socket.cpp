@@ -0,0 +1,216 @@
+#include "Socket.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+//Standard includes
+#include <utility>
+
+using namespace dae;
+
+namespace
+{
+#ifdef _WIN32
+	using NativeHandle = SOCKET;
+	using IoSize = int;
+	constexpr int SHUTDOWN_BOTH{ SD_BOTH };
+
+	inline void CloseNative( NativeHandle handle ) { closesocket( handle ); }
+#else
+	using NativeHandle = int;
+	using IoSize = size_t;
+	constexpr int SHUTDOWN_BOTH{ SHUT_RDWR };
+
+	inline void CloseNative( NativeHandle handle ) { close( handle ); }
+#endif
+
+	constexpr intptr_t INVALID_HANDLE{ -1 };
+
+	inline NativeHandle ToNative( intptr_t handle ) { return NativeHandle( handle ); }
+
+	// Tiles are small request/response messages, don't let Nagle hold them back
+	void DisableNagle( NativeHandle handle )
+	{
+		const int isEnabled{ 1 };
+		setsockopt( handle, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>( &isEnabled ), sizeof( isEnabled ) );
+	}
+}
+
+Socket::~Socket( )
+{
+	Close( );
+}
+
+Socket::Socket( Socket&& other ) noexcept :
+	m_Handle{ std::exchange( other.m_Handle, INVALID_HANDLE ) }
+{
+}
+
+Socket& Socket::operator=( Socket&& other ) noexcept
+{
+	if ( this != &other )
+	{
+		Close( );
+		m_Handle = std::exchange( other.m_Handle, INVALID_HANDLE );
+	}
+	return *this;
+}
+
+bool Socket::InitializeLibrary( )
+{
+#ifdef _WIN32
+	WSADATA data{};
+	return WSAStartup( MAKEWORD( 2, 2 ), &data ) == 0;
+#else
+	return true;
+#endif
+}
+
+void Socket::ShutdownLibrary( )
+{
+#ifdef _WIN32
+	WSACleanup( );
+#endif
+}
+
+bool Socket::Listen( uint16_t port )
+{
+	Close( );
+
+	const NativeHandle handle{ socket( AF_INET, SOCK_STREAM, IPPROTO_TCP ) };
+	m_Handle = intptr_t( handle );
+	if ( !IsValid( ) )
+	{
+		return false;
+	}
+
+	// A restarted coordinator can take the port again right away
+	const int reuseAddress{ 1 };
+	setsockopt( handle, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>( &reuseAddress ), sizeof( reuseAddress ) );
+
+	sockaddr_in address{};
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl( INADDR_ANY );
+	address.sin_port = htons( port );
+	if ( bind( handle, reinterpret_cast<const sockaddr*>( &address ), sizeof( address ) ) != 0
+		|| listen( handle, SOMAXCONN ) != 0 )
+	{
+		Close( );
+		return false;
+	}
+	return true;
+}
+
+Socket Socket::Accept( ) const
+{
+	Socket client{};
+	const NativeHandle handle{ accept( ToNative( m_Handle ), nullptr, nullptr ) };
+	client.m_Handle = intptr_t( handle );
+	if ( client.IsValid( ) )
+	{
+		DisableNagle( handle );
+	}
+	return client;
+}
+
+bool Socket::Connect( const std::string& host, uint16_t port )
+{
+	Close( );
+
+	addrinfo hints{};
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_protocol = IPPROTO_TCP;
+
+	addrinfo* pAddresses{};
+	if ( getaddrinfo( host.c_str( ), std::to_string( port ).c_str( ), &hints, &pAddresses ) != 0 )
+	{
+		return false;
+	}
+
+	for ( const addrinfo* pAddress{ pAddresses }; pAddress; pAddress = pAddress->ai_next )
+	{
+		const NativeHandle handle{ socket( pAddress->ai_family, pAddress->ai_socktype, pAddress->ai_protocol ) };
+		m_Handle = intptr_t( handle );
+		if ( !IsValid( ) )
+		{
+			continue;
+		}
+		if ( connect( handle, pAddress->ai_addr, int( pAddress->ai_addrlen ) ) == 0 )
+		{
+			DisableNagle( handle );
+			break;
+		}
+		Close( );
+	}
+
+	freeaddrinfo( pAddresses );
+	return IsValid( );
+}
+
+bool Socket::SendAll( const void* pData, size_t size ) const
+{
+	const char* pBytes{ static_cast<const char*>( pData ) };
+	while ( size > 0 )
+	{
+#ifdef _WIN32
+		const auto sent{ send( ToNative( m_Handle ), pBytes, IoSize( size ), 0 ) };
+#else
+		// A worker that went away must not kill the coordinator with SIGPIPE
+		const auto sent{ send( ToNative( m_Handle ), pBytes, IoSize( size ), MSG_NOSIGNAL ) };
+#endif
+		if ( sent <= 0 )
+		{
+			return false;
+		}
+		pBytes += sent;
+		size -= size_t( sent );
+	}
+	return true;
+}
+
+bool Socket::ReceiveAll( void* pData, size_t size ) const
+{
+	char* pBytes{ static_cast<char*>( pData ) };
+	while ( size > 0 )
+	{
+		const auto received{ recv( ToNative( m_Handle ), pBytes, IoSize( size ), 0 ) };
+		if ( received <= 0 )
+		{
+			return false;
+		}
+		pBytes += received;
+		size -= size_t( received );
+	}
+	return true;
+}
+
+void Socket::Shutdown( ) const
+{
+	if ( IsValid( ) )
+	{
+		shutdown( ToNative( m_Handle ), SHUTDOWN_BOTH );
+	}
+}
+
+void Socket::Close( )
+{
+	if ( IsValid( ) )
+	{
+		CloseNative( ToNative( m_Handle ) );
+		m_Handle = INVALID_HANDLE;
+	}
+}
+
+bool Socket::IsValid( ) const
+{
+	return m_Handle != INVALID_HANDLE;
+}
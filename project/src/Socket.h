@@ -0,0 +1,49 @@
+#pragma once
+
+//Standard includes
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace dae
+{
+	/**
+	 * \brief Blocking TCP socket over Winsock or BSD sockets. Every call reports failure through its
+	 * return value, a closed or broken connection just makes the next send or receive fail.
+	 * Movable so accepted connections can be handed to the thread that serves them.
+	 */
+	class Socket final
+	{
+	public:
+		Socket( ) = default;
+		~Socket( );
+
+		Socket( const Socket& ) = delete;
+		Socket( Socket&& other ) noexcept;
+		Socket& operator=( const Socket& ) = delete;
+		Socket& operator=( Socket&& other ) noexcept;
+
+		// Starts up the socket library (Winsock), call once before the first socket is opened
+		static bool InitializeLibrary( );
+		static void ShutdownLibrary( );
+
+		// Accepts connections on every interface
+		bool Listen( uint16_t port );
+		// Blocks until a client connects, the returned socket is invalid on failure
+		Socket Accept( ) const;
+		bool Connect( const std::string& host, uint16_t port );
+
+		// Both block until every byte went through, or fail
+		bool SendAll( const void* pData, size_t size ) const;
+		bool ReceiveAll( void* pData, size_t size ) const;
+
+		// Stops both directions, a thread blocked in ReceiveAll on this socket returns false
+		void Shutdown( ) const;
+		void Close( );
+		bool IsValid( ) const;
+
+	private:
+		// SOCKET on Windows, a file descriptor elsewhere
+		intptr_t m_Handle{ -1 };
+	};
+}
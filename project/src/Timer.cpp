@@ -22,6 +22,8 @@ void Timer::Reset()
 	m_BaseTime = currentTime;
 	m_PreviousTime = currentTime;
 	m_StopTime = 0;
+	m_TotalTime = 0.0f;
+	m_ElapsedTime = 0.0f;
 	m_FPSTimer = 0.0f;
 	m_FPSCount = 0;
 	m_IsStopped = false;
@@ -74,6 +76,13 @@ void Timer::Update()
 		return;
 	}
 
+	if (m_FixedTimeStep > 0.0f)
+	{
+		m_ElapsedTime = m_FixedTimeStep;
+		m_TotalTime += m_FixedTimeStep;
+		return;
+	}
+
 	const uint64_t currentTime = SDL_GetPerformanceCounter();
 	m_CurrentTime = currentTime;
 
@@ -131,6 +140,12 @@ void Timer::Update()
 	}
 }
 
+void Timer::SetFixedFrame(uint32_t frame)
+{
+	m_ElapsedTime = m_FixedTimeStep;
+	m_TotalTime = m_FixedTimeStep * static_cast<float>(frame);
+}
+
 void Timer::Stop()
 {
 	if (!m_IsStopped)
@@ -18,6 +18,11 @@ namespace dae
 		Timer& operator=(Timer&&) noexcept = delete;
 
 		void StartBenchmark(int numFrames = 10);
+		// Advance by a constant step on every Update instead of reading the clock (0 disables)
+		void SetFixedTimeStep(float timeStep) { m_FixedTimeStep = timeStep; };
+		// Fixed time step only: jumps straight to a frame, the total time becomes frame * time step.
+		// Frames rendered out of order or on separate timers still see the exact same time.
+		void SetFixedFrame(uint32_t frame);
 
 		void Reset();
 		void Start();
@@ -46,6 +51,7 @@ namespace dae
 		float m_SecondsPerCount = 0.0f;
 		float m_ElapsedUpperBound = 0.03f;
 		float m_FPSTimer = 0.0f;
+		float m_FixedTimeStep = 0.0f;
 
 		bool m_IsStopped = true;
 		bool m_ForceElapsedUpperBound = false;
@@ -275,26 +275,59 @@ namespace dae
 			}
 		}
 
-		static unsigned int i{};
-		inline Vector3 GetRandomPointInRadius( const Vector3& origin, const float& radius )
+		// Distance at which the brightest channel of a point light's radiance drops to cutoff
+		inline float GetInfluenceRadius( const Light& light, float cutoff )
 		{
-			// uniform numbers in a sphere
-			float u = Get1dNoiseZeroToOne( i );
-			float theta = 2.0f * M_PI * Get1dNoiseZeroToOne( ++i );
-			float phi = acos( 1.0f - 2.0f * u );
+			const float power{ light.intensity * std::max( light.color.r, std::max( light.color.g, light.color.b ) ) };
+			return sqrtf( std::max( power, 0.f ) / cutoff );
+		}
+
+		// Maps a 2D sample point in [0, 1) to the sphere around origin
+		inline Vector3 GetPointInRadius( const Vector3& origin, const float& radius, float u, float v )
+		{
+			// uniform numbers in a sphere, cos(phi) is uniform so phi itself is never needed
+			float sinTheta, cosTheta;
+			FastMath::SinCos( 2.0f * PI * v, sinTheta, cosTheta );
+			const float cosPhi = 1.0f - 2.0f * u;
+			const float sinPhi = sqrtf( std::max( 0.f, 1.0f - cosPhi * cosPhi ) );
 
 			// convert to cartesian coordinates
-			float sinPhi = sin( phi );
 			Vector3 randomPoint(
-				sinPhi * cos( theta ),
-				sinPhi * sin( theta ),
-				cos( phi )
+				sinPhi * cosTheta,
+				sinPhi * sinTheta,
+				cosPhi
 			);
 
 			return origin + randomPoint * radius;
 
 		}
 
+		// Orthonormal basis around the normal without a branch on its orientation (Duff et al. 2017)
+		inline void GetOrthonormalBasis( const Vector3& normal, Vector3& tangent, Vector3& bitangent )
+		{
+			const float sign{ std::copysign( 1.f, normal.z ) };
+			const float a{ -1.f / ( sign + normal.z ) };
+			const float b{ normal.x * normal.y * a };
+			tangent = { 1.f + sign * normal.x * normal.x * a, sign * b, -sign * normal.x };
+			bitangent = { b, sign + normal.y * normal.y * a, -normal.y };
+		}
+
+		// Maps a 2D sample point in [0, 1) to a direction around the normal, with a density of cos(theta) / PI
+		inline Vector3 GetCosineWeightedDirection( const Vector3& normal, float u, float v )
+		{
+			// Uniform points on the unit disk, projected up onto the hemisphere
+			const float radius{ sqrtf( u ) };
+			float sinPhi, cosPhi;
+			FastMath::SinCos( 2.f * PI * v, sinPhi, cosPhi );
+			const float x{ radius * cosPhi };
+			const float y{ radius * sinPhi };
+			const float z{ sqrtf( std::max( 0.f, 1.f - u ) ) };
+
+			Vector3 tangent, bitangent;
+			GetOrthonormalBasis( normal, tangent, bitangent );
+			return tangent * x + bitangent * y + normal * z;
+		}
+
 		/*inline float CalculateLambertCosineLaw( const Light& light, const HitRecord& hitRecord )
 		{
 			Vector3 lightDirection{};
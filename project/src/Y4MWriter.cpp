@@ -0,0 +1,311 @@
+#include "Y4MWriter.h"
+
+//External includes
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#include <emmintrin.h>
+#define Y4M_USE_SSE
+#endif
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <csignal>
+#endif
+
+//Standard includes
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Converted frames waiting for the I/O thread
+#define Y4M_QUEUED_FRAMES 4
+
+using namespace dae;
+
+namespace
+{
+	// Full range BT.601 (JFIF) in 8 bit fixed point, the weights of every row sum to 256 or 0
+	constexpr int LUMA_R{ 77 };
+	constexpr int LUMA_G{ 150 };
+	constexpr int LUMA_B{ 29 };
+	constexpr int CB_R{ -43 };
+	constexpr int CB_G{ -85 };
+	constexpr int CB_B{ 128 };
+	constexpr int CR_R{ 128 };
+	constexpr int CR_G{ -107 };
+	constexpr int CR_B{ -21 };
+	// Chroma is weighted over the sum of a 2x2 block: 8 bits of weight and 2 bits for the average.
+	// The offset moves it to 128 and rounds.
+	constexpr int CHROMA_SHIFT{ 10 };
+	constexpr int CHROMA_OFFSET{ ( 128 << CHROMA_SHIFT ) + ( 1 << ( CHROMA_SHIFT - 1 ) ) };
+
+	inline int GetRed( uint32_t pixel ) { return int( pixel >> 16 ) & 0xFF; }
+	inline int GetGreen( uint32_t pixel ) { return int( pixel >> 8 ) & 0xFF; }
+	inline int GetBlue( uint32_t pixel ) { return int( pixel ) & 0xFF; }
+
+	inline uint8_t GetLuma( uint32_t pixel )
+	{
+		return uint8_t( ( LUMA_R * GetRed( pixel ) + LUMA_G * GetGreen( pixel ) + LUMA_B * GetBlue( pixel ) + 128 ) >> 8 );
+	}
+
+	inline uint8_t GetChroma( int redSum, int greenSum, int blueSum, int weightR, int weightG, int weightB )
+	{
+		return uint8_t( std::clamp( ( weightR * redSum + weightG * greenSum + weightB * blueSum + CHROMA_OFFSET ) >> CHROMA_SHIFT, 0, 255 ) );
+	}
+
+#ifdef Y4M_USE_SSE
+	// Luma of 4 pixels, one per 32 bit lane. Channels and weights fit in the low 16 bits, so a 16 bit multiply is exact.
+	inline __m128i GetLuma4( __m128i pixels )
+	{
+		const __m128i channelMask{ _mm_set1_epi32( 0xFF ) };
+		const __m128i red{ _mm_and_si128( _mm_srli_epi32( pixels, 16 ), channelMask ) };
+		const __m128i green{ _mm_and_si128( _mm_srli_epi32( pixels, 8 ), channelMask ) };
+		const __m128i blue{ _mm_and_si128( pixels, channelMask ) };
+
+		const __m128i luma{ _mm_add_epi32(
+			_mm_add_epi32( _mm_mullo_epi16( red, _mm_set1_epi32( LUMA_R ) ), _mm_mullo_epi16( green, _mm_set1_epi32( LUMA_G ) ) ),
+			_mm_add_epi32( _mm_mullo_epi16( blue, _mm_set1_epi32( LUMA_B ) ), _mm_set1_epi32( 128 ) ) ) };
+		return _mm_srli_epi32( luma, 8 );
+	}
+
+	// Channel sums of the two 2x2 blocks under 4 pixels of two rows, as 16 bit b g r a b g r a
+	inline __m128i GetBlockSums( __m128i topPixels, __m128i bottomPixels )
+	{
+		const __m128i zero{ _mm_setzero_si128( ) };
+		__m128i left{ _mm_add_epi16( _mm_unpacklo_epi8( topPixels, zero ), _mm_unpacklo_epi8( bottomPixels, zero ) ) };
+		__m128i right{ _mm_add_epi16( _mm_unpackhi_epi8( topPixels, zero ), _mm_unpackhi_epi8( bottomPixels, zero ) ) };
+		left = _mm_add_epi16( left, _mm_srli_si128( left, 8 ) );
+		right = _mm_add_epi16( right, _mm_srli_si128( right, 8 ) );
+		return _mm_unpacklo_epi64( left, right );
+	}
+
+	// Weighted sums of both blocks in the two lowest 32 bit lanes
+	inline __m128i GetChroma2( __m128i blockSums, __m128i weights )
+	{
+		const __m128i pairs{ _mm_madd_epi16( blockSums, weights ) };
+		const __m128i sums{ _mm_add_epi32( pairs, _mm_srli_si128( pairs, 4 ) ) };
+		return _mm_shuffle_epi32( sums, _MM_SHUFFLE( 3, 3, 2, 0 ) );
+	}
+
+	// Chroma of 4 blocks from 8 pixels of two rows, stored as 4 bytes
+	inline void StoreChroma4( const __m128i sums[2], __m128i weights, uint8_t* pDestination )
+	{
+		__m128i chroma{ _mm_unpacklo_epi64( GetChroma2( sums[0], weights ), GetChroma2( sums[1], weights ) ) };
+		chroma = _mm_srai_epi32( _mm_add_epi32( chroma, _mm_set1_epi32( CHROMA_OFFSET ) ), CHROMA_SHIFT );
+		chroma = _mm_packs_epi32( chroma, chroma );
+		const int packed{ _mm_cvtsi128_si32( _mm_packus_epi16( chroma, chroma ) ) };
+		std::memcpy( pDestination, &packed, 4 );
+	}
+#endif
+}
+
+Y4MWriter::Y4MWriter( int width, int height, float frameRate ) :
+	m_Width{ width },
+	m_Height{ height },
+	m_FrameRate{ frameRate },
+	m_FrameSize{ size_t( width ) * height + 2 * size_t( ( width + 1 ) / 2 ) * ( ( height + 1 ) / 2 ) }
+{
+}
+
+Y4MWriter::~Y4MWriter( )
+{
+	Close( );
+}
+
+bool Y4MWriter::Open( const std::string& path )
+{
+	if ( path == "-" )
+	{
+#ifdef _WIN32
+		_setmode( _fileno( stdout ), _O_BINARY );
+#endif
+		m_pFile = stdout;
+		m_OwnsFile = false;
+	}
+	else
+	{
+		m_pFile = std::fopen( path.c_str( ), "wb" );
+		m_OwnsFile = true;
+	}
+	if ( !m_pFile )
+	{
+		return false;
+	}
+
+#ifndef _WIN32
+	// An encoder that quits early should fail the next write, not kill the process
+	std::signal( SIGPIPE, SIG_IGN );
+#endif
+
+	// Whole frame rates as n:1, anything else in thousandths
+	const bool isWholeRate{ std::floor( m_FrameRate ) == m_FrameRate };
+	const unsigned rateNumerator{ isWholeRate ? unsigned( m_FrameRate ) : unsigned( std::lround( m_FrameRate * 1000.f ) ) };
+	const unsigned rateDenominator{ isWholeRate ? 1u : 1000u };
+	if ( std::fprintf( m_pFile, "YUV4MPEG2 W%d H%d F%u:%u Ip A1:1 C420jpeg\n", m_Width, m_Height, rateNumerator, rateDenominator ) < 0 )
+	{
+		return false;
+	}
+
+	m_IsClosing = false;
+	m_HasFailed = false;
+	m_Thread = std::thread{ &Y4MWriter::Run, this };
+	return true;
+}
+
+bool Y4MWriter::WriteFrame( const uint32_t* pPixels )
+{
+	std::vector<uint8_t> frame{};
+	{
+		std::unique_lock lock{ m_Mutex };
+		m_Changed.wait( lock, [this]( ) { return m_QueuedFrames.size( ) < Y4M_QUEUED_FRAMES || m_HasFailed; } );
+		if ( m_HasFailed )
+		{
+			return false;
+		}
+		if ( !m_FreeFrames.empty( ) )
+		{
+			frame = std::move( m_FreeFrames.back( ) );
+			m_FreeFrames.pop_back( );
+		}
+	}
+
+	frame.resize( m_FrameSize );
+	ConvertFrame( pPixels, frame.data( ) );
+
+	{
+		std::lock_guard lock{ m_Mutex };
+		m_QueuedFrames.push_back( std::move( frame ) );
+	}
+	m_Changed.notify_all( );
+	return true;
+}
+
+bool Y4MWriter::Close( )
+{
+	if ( m_Thread.joinable( ) )
+	{
+		{
+			std::lock_guard lock{ m_Mutex };
+			m_IsClosing = true;
+		}
+		m_Changed.notify_all( );
+		m_Thread.join( );
+	}
+
+	if ( m_pFile )
+	{
+		if ( m_OwnsFile ? std::fclose( m_pFile ) != 0 : std::fflush( m_pFile ) != 0 )
+		{
+			m_HasFailed = true;
+		}
+		m_pFile = nullptr;
+	}
+	return !m_HasFailed;
+}
+
+void Y4MWriter::Run( )
+{
+	while ( true )
+	{
+		std::vector<uint8_t> frame{};
+		bool hasFailed{};
+		{
+			std::unique_lock lock{ m_Mutex };
+			m_Changed.wait( lock, [this]( ) { return !m_QueuedFrames.empty( ) || m_IsClosing; } );
+			if ( m_QueuedFrames.empty( ) )
+			{
+				return;
+			}
+			frame = std::move( m_QueuedFrames.front( ) );
+			m_QueuedFrames.pop_front( );
+			hasFailed = m_HasFailed;
+		}
+
+		// After a failed write the rest is dropped, WriteFrame already reports the failure
+		if ( !hasFailed )
+		{
+			hasFailed = std::fputs( "FRAME\n", m_pFile ) < 0
+				|| std::fwrite( frame.data( ), 1, frame.size( ), m_pFile ) != frame.size( )
+				|| std::fflush( m_pFile ) != 0;
+		}
+
+		{
+			std::lock_guard lock{ m_Mutex };
+			m_HasFailed = hasFailed;
+			m_FreeFrames.push_back( std::move( frame ) );
+		}
+		m_Changed.notify_all( );
+	}
+}
+
+void Y4MWriter::ConvertFrame( const uint32_t* pPixels, uint8_t* pFrame ) const
+{
+	const int chromaWidth{ ( m_Width + 1 ) / 2 };
+	const int chromaHeight{ ( m_Height + 1 ) / 2 };
+	uint8_t* pLuma{ pFrame };
+	uint8_t* pBlueDifference{ pLuma + size_t( m_Width ) * m_Height };
+	uint8_t* pRedDifference{ pBlueDifference + size_t( chromaWidth ) * chromaHeight };
+
+	for ( int py{}; py < m_Height; ++py )
+	{
+		const uint32_t* pRow{ pPixels + size_t( py ) * m_Width };
+		uint8_t* pLumaRow{ pLuma + size_t( py ) * m_Width };
+		int px{};
+#ifdef Y4M_USE_SSE
+		for ( ; px + 8 <= m_Width; px += 8 )
+		{
+			const __m128i luma{ _mm_packs_epi32(
+				GetLuma4( _mm_loadu_si128( reinterpret_cast<const __m128i*>( pRow + px ) ) ),
+				GetLuma4( _mm_loadu_si128( reinterpret_cast<const __m128i*>( pRow + px + 4 ) ) ) ) };
+			_mm_storel_epi64( reinterpret_cast<__m128i*>( pLumaRow + px ), _mm_packus_epi16( luma, luma ) );
+		}
+#endif
+		for ( ; px < m_Width; ++px )
+		{
+			pLumaRow[px] = GetLuma( pRow[px] );
+		}
+	}
+
+#ifdef Y4M_USE_SSE
+	const __m128i blueDifferenceWeights{ _mm_setr_epi16( CB_B, CB_G, CB_R, 0, CB_B, CB_G, CB_R, 0 ) };
+	const __m128i redDifferenceWeights{ _mm_setr_epi16( CR_B, CR_G, CR_R, 0, CR_B, CR_G, CR_R, 0 ) };
+#endif
+	for ( int cy{}; cy < chromaHeight; ++cy )
+	{
+		// The last row and column are repeated when the size is odd
+		const uint32_t* pTopRow{ pPixels + size_t( 2 * cy ) * m_Width };
+		const uint32_t* pBottomRow{ pPixels + size_t( std::min( 2 * cy + 1, m_Height - 1 ) ) * m_Width };
+		uint8_t* pBlueDifferenceRow{ pBlueDifference + size_t( cy ) * chromaWidth };
+		uint8_t* pRedDifferenceRow{ pRedDifference + size_t( cy ) * chromaWidth };
+
+		int cx{};
+#ifdef Y4M_USE_SSE
+		for ( ; 2 * cx + 8 <= m_Width; cx += 4 )
+		{
+			const __m128i sums[2]{
+				GetBlockSums( _mm_loadu_si128( reinterpret_cast<const __m128i*>( pTopRow + 2 * cx ) ),
+					_mm_loadu_si128( reinterpret_cast<const __m128i*>( pBottomRow + 2 * cx ) ) ),
+				GetBlockSums( _mm_loadu_si128( reinterpret_cast<const __m128i*>( pTopRow + 2 * cx + 4 ) ),
+					_mm_loadu_si128( reinterpret_cast<const __m128i*>( pBottomRow + 2 * cx + 4 ) ) ) };
+			StoreChroma4( sums, blueDifferenceWeights, pBlueDifferenceRow + cx );
+			StoreChroma4( sums, redDifferenceWeights, pRedDifferenceRow + cx );
+		}
+#endif
+		for ( ; cx < chromaWidth; ++cx )
+		{
+			const int left{ 2 * cx };
+			const int right{ std::min( 2 * cx + 1, m_Width - 1 ) };
+			const uint32_t block[4]{ pTopRow[left], pTopRow[right], pBottomRow[left], pBottomRow[right] };
+
+			int redSum{}, greenSum{}, blueSum{};
+			for ( const uint32_t pixel : block )
+			{
+				redSum += GetRed( pixel );
+				greenSum += GetGreen( pixel );
+				blueSum += GetBlue( pixel );
+			}
+			pBlueDifferenceRow[cx] = GetChroma( redSum, greenSum, blueSum, CB_R, CB_G, CB_B );
+			pRedDifferenceRow[cx] = GetChroma( redSum, greenSum, blueSum, CR_R, CR_G, CR_B );
+		}
+	}
+}
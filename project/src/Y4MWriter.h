@@ -0,0 +1,62 @@
+#pragma once
+
+//Standard includes
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dae
+{
+	/**
+	 * \brief Streams frames as uncompressed YUV4MPEG2 (4:2:0, full range BT.601) to a file, a named pipe or stdout,
+	 * so an external encoder can consume them while rendering goes on. Frames are converted on the calling thread
+	 * and written by a dedicated I/O thread. The queue between them is bounded: a slow consumer makes WriteFrame
+	 * wait instead of piling up frames in memory.
+	 */
+	class Y4MWriter final
+	{
+	public:
+		Y4MWriter( int width, int height, float frameRate );
+		~Y4MWriter( );
+
+		Y4MWriter( const Y4MWriter& ) = delete;
+		Y4MWriter( Y4MWriter&& ) noexcept = delete;
+		Y4MWriter& operator=( const Y4MWriter& ) = delete;
+		Y4MWriter& operator=( Y4MWriter&& ) noexcept = delete;
+
+		// "-" writes to stdout. Writes the stream header and starts the I/O thread.
+		bool Open( const std::string& path );
+		// Converts an ARGB8888 frame and queues it, waits while the queue is full. False once a write failed.
+		bool WriteFrame( const uint32_t* pPixels );
+		// Waits until every queued frame is written, then closes the stream. False if any write failed.
+		bool Close( );
+
+	private:
+		int m_Width;
+		int m_Height;
+		float m_FrameRate;
+		// One Y plane at full resolution, U and V at half resolution, rounded up
+		size_t m_FrameSize;
+
+		std::FILE* m_pFile{};
+		bool m_OwnsFile{ false };
+
+		std::mutex m_Mutex{};
+		std::condition_variable m_Changed{};
+		std::deque<std::vector<uint8_t>> m_QueuedFrames{};
+		// Written frames, reused so the steady state allocates nothing
+		std::vector<std::vector<uint8_t>> m_FreeFrames{};
+		bool m_IsClosing{ false };
+		bool m_HasFailed{ false };
+
+		std::thread m_Thread{};
+
+		void Run( );
+		void ConvertFrame( const uint32_t* pPixels, uint8_t* pFrame ) const;
+	};
+}
@@ -10,6 +10,21 @@ struct LogInfo
 	int lightingMode;
 	int shadowMode;
 	bool gi;
+	bool accumulation;
+	uint32_t accumulatedFrames;
+	bool adaptive;
+	uint32_t convergedTiles;
+	uint32_t totalTiles;
+	bool checkerboard;
+	bool dirtyRegions;
+	uint32_t dirtyTiles;
+	bool denoiser;
+	int renderWidth;
+	int renderHeight;
+	int shadowSamples;
+	int indirectSamples;
+	int sampleSequence;
+	int integrator;
 	float dFPS;
 };
 
@@ -26,6 +41,18 @@ static std::string shadowModeMap[]{
 	"None"
 };
 
+static std::string sampleSequenceMap[]{
+	"White noise",
+	"Sobol (Owen scrambled)",
+	"R2",
+	"Blue noise"
+};
+
+static std::string integratorModeMap[]{
+	"Whitted",
+	"Path tracer"
+};
+
 static void LogSceneInfo( float dFPS )
 {
 	std::cout << "dFPS: " << dFPS << std::endl;
@@ -42,6 +69,14 @@ static void LogSceneInfo( const std::string& state )
 	std::cout << "| Mode:      " << std::setw( 40 ) << state << "|" << std::endl;
 	std::cout << "| Shadows:                                           |" << std::endl;
 	std::cout << "| GI:                                                |" << std::endl;
+	std::cout << "| Accum:                                             |" << std::endl;
+	std::cout << "| Adaptive:                                          |" << std::endl;
+	std::cout << "| Checker:                                           |" << std::endl;
+	std::cout << "| Dirty:                                             |" << std::endl;
+	std::cout << "| Denoise:                                           |" << std::endl;
+	std::cout << "| Quality:                                           |" << std::endl;
+	std::cout << "| Samples:                                           |" << std::endl;
+	std::cout << "| Tracer:                                            |" << std::endl;
 	std::cout << "+----------------------------------------------------+" << std::endl;
 }
 
@@ -56,5 +91,14 @@ static void LogSceneInfo( const LogInfo& logInfo )
 	std::cout << "| Mode:      " << std::setw( 40 ) << lightingModeMap[logInfo.lightingMode] << "|" << std::endl;
 	std::cout << "| Shadows:   " << std::setw( 40 ) << shadowModeMap[logInfo.shadowMode] << "|" << std::endl;
 	std::cout << "| GI:        " << std::setw( 40 ) << logInfo.gi << "|" << std::endl;
+	std::cout << "| Accum:     " << std::setw( 40 ) << ( logInfo.accumulation ? std::to_string( logInfo.accumulatedFrames ) + " frames" : "false" ) << "|" << std::endl;
+	std::cout << "| Adaptive:  " << std::setw( 40 ) << ( logInfo.adaptive ? std::to_string( logInfo.convergedTiles ) + "/" + std::to_string( logInfo.totalTiles ) + " tiles converged" : "false" ) << "|" << std::endl;
+	std::cout << "| Checker:   " << std::setw( 40 ) << logInfo.checkerboard << "|" << std::endl;
+	std::cout << "| Dirty:     " << std::setw( 40 ) << ( logInfo.dirtyRegions ? std::to_string( logInfo.dirtyTiles ) + "/" + std::to_string( logInfo.totalTiles ) + " tiles traced" : "false" ) << "|" << std::endl;
+	std::cout << "| Denoise:   " << std::setw( 40 ) << logInfo.denoiser << "|" << std::endl;
+	std::cout << "| Quality:   " << std::setw( 40 ) << std::to_string( logInfo.renderWidth ) + "x" + std::to_string( logInfo.renderHeight )
+		+ ", " + std::to_string( logInfo.shadowSamples ) + " shadow / " + std::to_string( logInfo.indirectSamples ) + " GI samples" << "|" << std::endl;
+	std::cout << "| Samples:   " << std::setw( 40 ) << sampleSequenceMap[logInfo.sampleSequence] << "|" << std::endl;
+	std::cout << "| Tracer:    " << std::setw( 40 ) << integratorModeMap[logInfo.integrator] << "|" << std::endl;
 	std::cout << "+----------------------------------------------------+" << std::endl;
 }
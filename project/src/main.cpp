@@ -7,10 +7,23 @@
 #undef main
 
 //Standard includes
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <string>
+#include <thread>
 #include <vector>
 
 //Project includes
+#include "Benchmark.h"
+#include "CommandQueue.h"
+#include "DistributedRendering.h"
+#include "FrameGovernor.h"
+#include "Profiler.h"
+#include "SceneLoader.h"
+#include "SequenceRenderer.h"
 #include "Timer.h"
+#include "Y4MWriter.h"
 #include "Renderer.h"
 #include "Scene.h"
 
@@ -18,33 +31,404 @@
 
 using namespace dae;
 
-static void LoadScene( Scene** pScene, const std::function<Scene* ( )>& fnFactory )
+void ShutDown( SDL_Window* pWindow )
 {
-	delete *pScene;
-	*pScene = fnFactory();
+	SDL_DestroyWindow( pWindow );
+	SDL_Quit( );
+}
 
-	LogSceneInfo( "Initializing ..." );
-	( *pScene )->Initialize( );
+static void DumpTrace( const std::string& path )
+{
+	if ( !Profiler::IsEnabled( ) )
+		std::cout << "Profiling zones are not compiled in, build with ENABLE_PROFILING." << std::endl;
+	else if ( Profiler::WriteChromeTrace( path ) )
+		std::cout << "Trace saved to " << path << "!" << std::endl;
+	else
+		std::cout << "Something went wrong. Trace not saved!" << std::endl;
 }
 
-void ShutDown( SDL_Window* pWindow )
+// --trace [file.json] writes the profiling zones when the program exits
+static bool ParseTraceArguments( int argc, char* args[], std::string& path )
 {
-	SDL_DestroyWindow( pWindow );
+	for ( int i{ 1 }; i < argc; ++i )
+	{
+		if ( std::string{ args[i] } == "--trace" )
+		{
+			if ( i + 1 < argc && args[i + 1][0] != '-' )
+			{
+				path = args[i + 1];
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
+// --target-fps [fps] lets the frame governor hold that frame rate (30 by default)
+static bool ParseGovernorArguments( int argc, char* args[], float& targetFps )
+{
+	for ( int i{ 1 }; i < argc; ++i )
+	{
+		if ( std::string{ args[i] } == "--target-fps" )
+		{
+			if ( i + 1 < argc && std::isdigit( static_cast<unsigned char>( args[i + 1][0] ) ) )
+			{
+				targetFps = std::max( 1.f, std::stof( args[i + 1] ) );
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
+// Every registered scene, in course order
+static std::vector<std::function<Scene* ( )>> CreateSceneFactories( )
+{
+	return {
+		[]( ) -> Scene* { return new Scene_W1( ); },
+		[]( ) -> Scene* { return new Scene_W2( ); },
+		[]( ) -> Scene* { return new Scene_W3_TestScene( ); },
+		[]( ) -> Scene* { return new Scene_W3( ); },
+		[]( ) -> Scene* { return new Scene_W4_TestScene( ); },
+		[]( ) -> Scene* { return new Scene_W4_ReferenceScene( ); },
+		[]( ) -> Scene* { return new Scene_W4_BunnyScene( ); }
+	};
+}
+
+// --benchmark [frames] [--benchmark-out file.json]
+static bool ParseBenchmarkArguments( int argc, char* args[], BenchmarkSettings& settings )
+{
+	bool isBenchmark{ false };
+	for ( int i{ 1 }; i < argc; ++i )
+	{
+		const std::string argument{ args[i] };
+		if ( argument == "--benchmark" )
+		{
+			isBenchmark = true;
+			if ( i + 1 < argc && std::isdigit( static_cast<unsigned char>( args[i + 1][0] ) ) )
+			{
+				settings.framesPerRun = std::max( 1, std::stoi( args[++i] ) );
+			}
+		}
+		else if ( argument == "--benchmark-out" && i + 1 < argc )
+		{
+			settings.outputPath = args[++i];
+		}
+	}
+	return isBenchmark;
+}
+
+static int RunBenchmark( const BenchmarkSettings& settings, int width, int height )
+{
+	SDL_Init( 0 );
+
+	const auto pRenderer = new Renderer( width, height );
+	Benchmark benchmark{ pRenderer, CreateSceneFactories( ), settings };
+	const bool succeeded{ benchmark.Run( ) };
+	delete pRenderer;
+
 	SDL_Quit( );
+	return succeeded ? 0 : 1;
 }
 
-int main( int argc, char* args[] )
+// WxH, left untouched when malformed
+static void ParseSize( const std::string& size, int& width, int& height )
 {
-	//Unreferenced parameters
-	(void) argc;
-	(void) args;
+	const size_t separatorIdx{ size.find( 'x' ) };
+	if ( separatorIdx != std::string::npos )
+	{
+		width = std::max( 1, std::stoi( size.substr( 0, separatorIdx ) ) );
+		height = std::max( 1, std::stoi( size.substr( separatorIdx + 1 ) ) );
+	}
+}
 
-	//Create window + surfaces
-	SDL_Init( SDL_INIT_VIDEO );
+enum class DistributedRole
+{
+	None,
+	Coordinator,
+	Worker
+};
+
+// --coordinator [port] [--workers count] [--size WxH] [--scene idx] [--scene-time seconds] [--distributed-out file.bmp]
+// --worker [host:port]
+static DistributedRole ParseDistributedArguments( int argc, char* args[], DistributedSettings& settings )
+{
+	DistributedRole role{ DistributedRole::None };
+	for ( int i{ 1 }; i < argc; ++i )
+	{
+		const std::string argument{ args[i] };
+		const bool hasValue{ i + 1 < argc && args[i + 1][0] != '-' };
+		if ( argument == "--coordinator" )
+		{
+			role = DistributedRole::Coordinator;
+			if ( hasValue )
+			{
+				settings.port = uint16_t( std::stoi( args[++i] ) );
+			}
+		}
+		else if ( argument == "--worker" )
+		{
+			role = DistributedRole::Worker;
+			if ( hasValue )
+			{
+				const std::string address{ args[++i] };
+				const size_t separatorIdx{ address.rfind( ':' ) };
+				settings.host = address.substr( 0, separatorIdx );
+				if ( separatorIdx != std::string::npos )
+				{
+					settings.port = uint16_t( std::stoi( address.substr( separatorIdx + 1 ) ) );
+				}
+			}
+		}
+		else if ( argument == "--workers" && hasValue )
+		{
+			settings.workerCount = uint32_t( std::max( 1, std::stoi( args[++i] ) ) );
+		}
+		else if ( argument == "--size" && hasValue )
+		{
+			ParseSize( args[++i], settings.width, settings.height );
+		}
+		else if ( argument == "--scene" && hasValue )
+		{
+			settings.sceneIdx = uint32_t( std::stoi( args[++i] ) );
+		}
+		else if ( argument == "--scene-time" && hasValue )
+		{
+			settings.sceneTime = std::max( 0.f, std::stof( args[++i] ) );
+		}
+		else if ( argument == "--distributed-out" && hasValue )
+		{
+			settings.outputPath = args[++i];
+		}
+	}
+	return role;
+}
+
+static int RunDistributed( DistributedRole role, const DistributedSettings& settings )
+{
+	SDL_Init( 0 );
+	if ( !Socket::InitializeLibrary( ) )
+	{
+		SDL_Quit( );
+		return 1;
+	}
+
+	bool succeeded{};
+	if ( role == DistributedRole::Coordinator )
+	{
+		RenderCoordinator coordinator{ CreateSceneFactories( ), settings };
+		succeeded = coordinator.Run( );
+	}
+	else
+	{
+		RenderWorker worker{ CreateSceneFactories( ), settings };
+		succeeded = worker.Run( );
+	}
+
+	Socket::ShutdownLibrary( );
+	SDL_Quit( );
+	return succeeded ? 0 : 1;
+}
+
+// --sequence [first] [last] [--fps rate] [--frames-in-flight count] [--size WxH] [--scene idx] [--sequence-out prefix] [--y4m [file|-]]
+static bool ParseSequenceArguments( int argc, char* args[], SequenceSettings& settings )
+{
+	bool isSequence{ false };
+	for ( int i{ 1 }; i < argc; ++i )
+	{
+		const std::string argument{ args[i] };
+		const bool hasValue{ i + 1 < argc && args[i + 1][0] != '-' };
+		if ( argument == "--sequence" )
+		{
+			isSequence = true;
+			if ( hasValue && std::isdigit( static_cast<unsigned char>( args[i + 1][0] ) ) )
+			{
+				settings.firstFrame = uint32_t( std::stoi( args[++i] ) );
+				settings.lastFrame = settings.firstFrame;
+				if ( i + 1 < argc && std::isdigit( static_cast<unsigned char>( args[i + 1][0] ) ) )
+				{
+					settings.lastFrame = uint32_t( std::stoi( args[++i] ) );
+				}
+			}
+		}
+		else if ( argument == "--fps" && hasValue )
+		{
+			settings.frameRate = std::max( 1.f, std::stof( args[++i] ) );
+		}
+		else if ( argument == "--frames-in-flight" && hasValue )
+		{
+			settings.framesInFlight = uint32_t( std::max( 1, std::stoi( args[++i] ) ) );
+		}
+		else if ( argument == "--size" && hasValue )
+		{
+			ParseSize( args[++i], settings.width, settings.height );
+		}
+		else if ( argument == "--scene" && hasValue )
+		{
+			settings.sceneIdx = uint32_t( std::stoi( args[++i] ) );
+		}
+		else if ( argument == "--sequence-out" && hasValue )
+		{
+			settings.outputPath = args[++i];
+		}
+		else if ( argument == "--y4m" )
+		{
+			settings.videoPath = "-";
+			if ( i + 1 < argc && ( hasValue || std::string{ args[i + 1] } == "-" ) )
+			{
+				settings.videoPath = args[++i];
+			}
+		}
+	}
+	return isSequence;
+}
 
+static int RunSequence( const SequenceSettings& settings )
+{
+	SDL_Init( 0 );
+
+	// Every frame goes to its own numbered image, prefix0000.bmp onwards
+	SDL_Surface* pFrame{ SDL_CreateRGBSurfaceWithFormat( 0, settings.width, settings.height, 32, SDL_PIXELFORMAT_ARGB8888 ) };
+	const auto fnSaveFrame = [&settings, pFrame]( uint32_t frame, const uint32_t* pPixels )
+		{
+			uint8_t* pSurfacePixels{ static_cast<uint8_t*>( pFrame->pixels ) };
+			for ( int py{}; py < settings.height; ++py )
+			{
+				std::copy_n( pPixels + py * settings.width, settings.width, reinterpret_cast<uint32_t*>( pSurfacePixels + py * pFrame->pitch ) );
+			}
+
+			std::string index{ std::to_string( frame ) };
+			index.insert( 0, index.size( ) < 4 ? 4 - index.size( ) : 0, '0' );
+			return SDL_SaveBMP( pFrame, ( settings.outputPath + index + ".bmp" ).c_str( ) ) == 0;
+		};
+
+	SequenceRenderer sequenceRenderer{ CreateSceneFactories( ), settings };
+	bool succeeded{};
+	if ( settings.videoPath.empty( ) )
+	{
+		succeeded = sequenceRenderer.Run( fnSaveFrame );
+	}
+	else
+	{
+		// The video owns stdout, progress goes to stderr
+		std::streambuf* pOutputBuffer{ std::cout.rdbuf( ) };
+		if ( settings.videoPath == "-" )
+		{
+			std::cout.rdbuf( std::cerr.rdbuf( ) );
+		}
+
+		Y4MWriter videoWriter{ settings.width, settings.height, settings.frameRate };
+		if ( videoWriter.Open( settings.videoPath ) )
+		{
+			succeeded = sequenceRenderer.Run( [&videoWriter]( uint32_t, const uint32_t* pPixels ) { return videoWriter.WriteFrame( pPixels ); } );
+			succeeded = videoWriter.Close( ) && succeeded;
+		}
+		else
+		{
+			std::cout << "Could not open " << settings.videoPath << " for writing!" << std::endl;
+		}
+		std::cout.rdbuf( pOutputBuffer );
+	}
+
+	SDL_FreeSurface( pFrame );
+	SDL_Quit( );
+	return succeeded ? 0 : 1;
+}
+
+// Update, render and statistics, one frame after the other until the main thread stops looping
+static void RenderLoop( Scene** ppScene, Renderer* pRenderer, Timer* pTimer, CommandQueue* pCommands, SceneLoader* pSceneLoader, FrameGovernor* pGovernor, const std::atomic<bool>* pIsLooping )
+{
+	Profiler::SetThreadName( "Render" );
+
+	float printTimer = 0.f;
+	while ( pIsLooping->load( ) )
+	{
+		PROFILE_SCOPE( "Frame" );
+
+		//--------- Commands ---------
+		pCommands->Execute( );
+
+		// Swap in a scene the loader finished, the old one is destroyed on the loader thread
+		if ( Scene* pLoadedScene{ pSceneLoader->TakeLoadedScene( ) } )
+		{
+			pSceneLoader->Release( *ppScene );
+			*ppScene = pLoadedScene;
+			pRenderer->ResetSceneCaches( );
+		}
+		Scene* pScene{ *ppScene };
+
+		//--------- Update ---------
+		{
+			PROFILE_SCOPE( "Scene::Update" );
+			pScene->Update( pTimer );
+		}
+
+		//--------- Render ---------
+		pRenderer->Render( pScene );
+
+		//--------- Timer ---------
+		pTimer->Update( );
+		pGovernor->Update( pTimer->GetElapsed( ) );
+		printTimer += pTimer->GetElapsed( );
+		if ( printTimer >= 1.f )
+		{
+			PROFILE_SCOPE( "LogSceneInfo" );
+			printTimer = 0.f;
+#ifdef USE_SIMPLE_OUTPUT 
+			LogSceneInfo( pTimer->GetdFPS( ) );
+#else
+			LogSceneInfo( pScene, pRenderer, pTimer->GetdFPS( ) );
+#endif
+		}
+	}
+}
+
+int main( int argc, char* args[] )
+{
 	const uint32_t width = 640;
 	const uint32_t height = 480;
 
+	Profiler::SetThreadName( "Main" );
+	std::string tracePath{ "trace.json" };
+	const bool traceOnExit{ ParseTraceArguments( argc, args, tracePath ) };
+
+	//Headless benchmark mode
+	if ( BenchmarkSettings benchmarkSettings{}; ParseBenchmarkArguments( argc, args, benchmarkSettings ) )
+	{
+		const int result{ RunBenchmark( benchmarkSettings, width, height ) };
+		if ( traceOnExit )
+		{
+			DumpTrace( tracePath );
+		}
+		return result;
+	}
+
+	//Headless animation sequence
+	if ( SequenceSettings sequenceSettings{}; ParseSequenceArguments( argc, args, sequenceSettings ) )
+	{
+		const int result{ RunSequence( sequenceSettings ) };
+		if ( traceOnExit )
+		{
+			DumpTrace( tracePath );
+		}
+		return result;
+	}
+
+	//Headless distributed rendering, one coordinator and any number of worker processes
+	DistributedSettings distributedSettings{};
+	if ( const DistributedRole role{ ParseDistributedArguments( argc, args, distributedSettings ) }; role != DistributedRole::None )
+	{
+		const int result{ RunDistributed( role, distributedSettings ) };
+		if ( traceOnExit )
+		{
+			DumpTrace( tracePath );
+		}
+		return result;
+	}
+
+	//Create window + surfaces
+	SDL_Init( SDL_INIT_VIDEO );
+
 	SDL_Window* pWindow = SDL_CreateWindow(
 		"RayTracer - Alessandro Manzini",
 		SDL_WINDOWPOS_UNDEFINED,
@@ -81,19 +465,33 @@ int main( int argc, char* args[] )
 	// Start Benchmark
 	// pTimer->StartBenchmark();
 
-	float printTimer = 0.f;
-	bool isLooping = true;
+	// The render thread owns the scene, the renderer state and the timer from here on,
+	// the main thread only handles input and presents finished frames
+	float targetFps{ 30.f };
+	const bool isGoverned{ ParseGovernorArguments( argc, args, targetFps ) };
+	FrameGovernor governor{ pRenderer, 1.f / targetFps };
+	governor.SetEnabled( isGoverned );
+
+	CommandQueue commands{};
+	SceneLoader sceneLoader{};
+	std::atomic<bool> isLooping{ true };
+	std::thread renderThread{ RenderLoop, &pScene, pRenderer, pTimer, &commands, &sceneLoader, &governor, &isLooping };
+
 	bool takeScreenshot = false;
-	while ( isLooping )
+	bool dumpTrace = false;
+	uint64_t inputCounter{ SDL_GetPerformanceCounter( ) };
+	CameraInput cameraInput{};
+	while ( isLooping.load( ) )
 	{
 		//--------- Get input events ---------
 		SDL_Event e;
 		while ( SDL_PollEvent( &e ) )
 		{
+			PROFILE_SCOPE( "Events" );
 			switch ( e.type )
 			{
 			case SDL_QUIT:
-				isLooping = false;
+				isLooping.store( false );
 				break;
 			case SDL_KEYUP:
 				switch ( e.key.keysym.scancode )
@@ -101,19 +499,46 @@ int main( int argc, char* args[] )
 				case SDL_SCANCODE_X:
 					takeScreenshot = true;
 					break;
+				case SDL_SCANCODE_P:
+					dumpTrace = true;
+					break;
 
 				case SDL_SCANCODE_F2:
-					pRenderer->ToggleShadows( );
+					commands.Push( [pRenderer] { pRenderer->ToggleShadows( ); } );
 					break;
 				case SDL_SCANCODE_F3:
-					pRenderer->ToggleLightingMode( );
+					commands.Push( [pRenderer] { pRenderer->ToggleLightingMode( ); } );
 					break;
 				case SDL_SCANCODE_F4:
-					pRenderer->ToggleGlobalIllumination( );
+					commands.Push( [pRenderer] { pRenderer->ToggleGlobalIllumination( ); } );
+					break;
+				case SDL_SCANCODE_F5:
+					commands.Push( [pRenderer] { pRenderer->ToggleAccumulation( ); } );
+					break;
+				case SDL_SCANCODE_F6:
+					commands.Push( [pRenderer] { pRenderer->ToggleAdaptiveSampling( ); } );
+					break;
+				case SDL_SCANCODE_F7:
+					commands.Push( [pRenderer] { pRenderer->ToggleCheckerboard( ); } );
+					break;
+				case SDL_SCANCODE_F8:
+					commands.Push( [&governor] { governor.ToggleEnabled( ); } );
+					break;
+				case SDL_SCANCODE_F9:
+					commands.Push( [pRenderer] { pRenderer->ToggleDirtyRegions( ); } );
+					break;
+				case SDL_SCANCODE_F10:
+					commands.Push( [pRenderer] { pRenderer->ToggleDenoiser( ); } );
+					break;
+				case SDL_SCANCODE_F11:
+					commands.Push( [pRenderer] { pRenderer->ToggleSampleSequence( ); } );
+					break;
+				case SDL_SCANCODE_F12:
+					commands.Push( [pRenderer] { pRenderer->ToggleIntegratorMode( ); } );
 					break;
 				case SDL_SCANCODE_UP:
 					sceneIndex = ( sceneIndex + 1 ) % sceneFactories.size( );
-					LoadScene( &pScene, sceneFactories.at( sceneIndex ) );
+					sceneLoader.Load( sceneFactories.at( sceneIndex ) );
 					break;
 				case SDL_SCANCODE_DOWN:
 					if ( sceneIndex < 1 )
@@ -124,7 +549,7 @@ int main( int argc, char* args[] )
 					{
 						--sceneIndex;
 					}
-					LoadScene( &pScene, sceneFactories.at( sceneIndex ) );
+					sceneLoader.Load( sceneFactories.at( sceneIndex ) );
 					break;
 				}
 
@@ -132,39 +557,57 @@ int main( int argc, char* args[] )
 			}
 		}
 
-		//--------- Update ---------
-		pScene->Update( pTimer );
-
-		//--------- Render ---------
-		pRenderer->Render( pScene );
+		//--------- Camera input ---------
+		// Sampled at the pace of this loop instead of once per frame, so nothing that happens during a slow frame is lost
+		{
+			const uint64_t counter{ SDL_GetPerformanceCounter( ) };
+			Camera::SampleInput( float( counter - inputCounter ) / float( SDL_GetPerformanceFrequency( ) ), cameraInput );
+			inputCounter = counter;
+		}
 
-		//--------- Timer ---------
-		pTimer->Update( );
-		printTimer += pTimer->GetElapsed( );
-		if ( printTimer >= 1.f )
+		//--------- Present ---------
+		if ( pRenderer->Present( ) )
 		{
-			printTimer = 0.f;
-#ifdef USE_SIMPLE_OUTPUT 
-			LogSceneInfo( pTimer->GetdFPS( ) );
-#else
-			LogSceneInfo( pScene, pRenderer, pTimer->GetdFPS( ) );
-#endif
+			// Once per rendered frame, the render thread applies what piled up before its next frame
+			if ( !cameraInput.IsEmpty( ) )
+			{
+				commands.Push( [&pScene, cameraInput] { pScene->GetCamera( ).ApplyInput( cameraInput ); } );
+				cameraInput = {};
+			}
+		}
+		else
+		{
+			// Nothing new to show yet, don't spin while the render thread works
+			SDL_Delay( 1 );
 		}
 
-		//Save screenshot after full render
+		//Save screenshot of the presented frame
 		if ( takeScreenshot )
 		{
+			PROFILE_SCOPE( "SaveBufferToImage" );
 			if ( !pRenderer->SaveBufferToImage( ) )
 				std::cout << "Screenshot saved!" << std::endl;
 			else
 				std::cout << "Something went wrong. Screenshot not saved!" << std::endl;
 			takeScreenshot = false;
 		}
+
+		if ( dumpTrace )
+		{
+			DumpTrace( tracePath );
+			dumpTrace = false;
+		}
 	}
+	renderThread.join( );
 	pTimer->Stop( );
 
+	if ( traceOnExit )
+	{
+		DumpTrace( tracePath );
+	}
+
 	//Shutdown "framework"
-	delete pScene;
+	sceneLoader.Release( pScene );
 	delete pRenderer;
 	delete pTimer;
 
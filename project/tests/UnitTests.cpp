@@ -2,6 +2,8 @@
 #include "../src/Vector3.h"
 #include "../src/Vector4.h"
 #include "../src/Matrix.h"
+#include "../src/SIMD.h"
+#include "../src/FastMath.h"
 
 namespace dae
 {
@@ -35,6 +37,57 @@ namespace dae
 		EXPECT_EQ(dae::Vector3(-3.0f, 6.0f, -3.0f), dae::Vector3::Cross(v1, v2));
 	}
 
+	TEST(Vector3x8, MatchesScalar) {
+		Vector3 v1[8], v2[8];
+		for (int i{ 0 }; i < 8; ++i)
+		{
+			v1[i] = { float(i), 1.f - i, .5f * i };
+			v2[i] = { 2.f, float(i * i), -1.f };
+		}
+
+		const Vector3x8 wide1{ Vector3x8::Load(v1) };
+		const Vector3x8 wide2{ Vector3x8::Load(v2) };
+		const Float8 dots{ Vector3x8::Dot(wide1, wide2) };
+		const Vector3x8 crosses{ Vector3x8::Cross(wide1, wide2) };
+		for (int i{ 0 }; i < 8; ++i)
+		{
+			EXPECT_EQ(Vector3::Dot(v1[i], v2[i]), dots[i]);
+			EXPECT_EQ(Vector3::Cross(v1[i], v2[i]), crosses.Get(i));
+		}
+	}
+
+	TEST(FastMath, RSqrtError) {
+		for (int exponent{ -20 }; exponent <= 20; ++exponent)
+		{
+			for (float mantissa{ 1.f }; mantissa < 2.f; mantissa += 1.f / 64)
+			{
+				const float x{ std::ldexp(mantissa, exponent) };
+				EXPECT_NEAR(1.0, FastMath::RSqrtApprox(x) * std::sqrt(double(x)), 5e-6);
+			}
+		}
+	}
+
+	TEST(FastMath, SinCosError) {
+		// A few turns both ways, the angles the samplers pass stay within one
+		for (float angle{ -4 * PI_2 }; angle <= 4 * PI_2; angle += .001f)
+		{
+			float sine, cosine;
+			FastMath::SinCosApprox(angle, sine, cosine);
+			EXPECT_NEAR(std::sin(double(angle)), sine, 5e-7);
+			EXPECT_NEAR(std::cos(double(angle)), cosine, 5e-7);
+		}
+	}
+
+	TEST(MathHelpers, Pow) {
+		EXPECT_EQ(1.f, Pow<0>(3.f));
+		EXPECT_EQ(243.f, Pow<5>(3.f));
+		for (float x{ 0.f }; x < 2.f; x += .01f)
+		{
+			EXPECT_NEAR(std::pow(double(x), 4), Pow<4>(x), 1e-6 * std::pow(double(x), 4));
+			EXPECT_NEAR(std::pow(double(x), 5), Pow<5>(x), 1e-6 * std::pow(double(x), 5));
+		}
+	}
+
 	// W1
 
 	int main(int argc, char** argv) {